@@ -0,0 +1,272 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+#include <stddef.h>
+#include <new>
+#include <vector>
+#include "SENTDecoder.h"
+
+/* Structured dtype matching the layout of SENTMessage, created at import */
+static PyArray_Descr* message_descr = NULL;
+
+static PyArray_Descr* createMessageDescr()
+{
+	PyArray_Descr* descr = NULL;
+	PyObject* spec = Py_BuildValue( "{s:[sssssssss],s:[ssss(s(i))ssss],s:[nnnnnnnnn],s:n}",
+		"names", "start_sample", "end_sample", "value", "status", "data", "crc", "number_of_pulses", "error", "resynchronised",
+		"formats", "u8", "u8", "u4", "u1", "u1", SENT_MAX_DATA_NIBBLES, "u1", "u1", "u1", "u1",
+		"offsets", (Py_ssize_t)offsetof( SENTMessage, start_sample ), (Py_ssize_t)offsetof( SENTMessage, end_sample ),
+				   (Py_ssize_t)offsetof( SENTMessage, value ), (Py_ssize_t)offsetof( SENTMessage, status ),
+				   (Py_ssize_t)offsetof( SENTMessage, data ), (Py_ssize_t)offsetof( SENTMessage, crc ),
+				   (Py_ssize_t)offsetof( SENTMessage, number_of_pulses ), (Py_ssize_t)offsetof( SENTMessage, error ),
+				   (Py_ssize_t)offsetof( SENTMessage, resynchronised ),
+		"itemsize", (Py_ssize_t)sizeof( SENTMessage ) );
+	if( spec == NULL )
+	{
+		return NULL;
+	}
+	if( !PyArray_DescrConverter( spec, &descr ) )
+	{
+		descr = NULL;
+	}
+	Py_DECREF( spec );
+	return descr;
+}
+
+static void destroyMessages( PyObject* capsule )
+{
+	delete static_cast< std::vector<SENTMessage>* >( PyCapsule_GetPointer( capsule, NULL ) );
+}
+
+/** decode(falling_edges, samples_per_tick, data_nibbles=6, pause_pulse=True, legacy_crc=False, resync=False)
+ *
+ *  Decodes a SENT line given the sample numbers of its falling edges, see SENTDecoder.
+ *  The edges should be non-negative and strictly increasing, this is checked before the GIL is released.
+ *  The decoding runs without the GIL, so several captures can be decoded in parallel from Python threads.
+ *  The returned structured array shares its memory with the decoded messages, no copy is made.
+ */
+static PyObject* decode( PyObject* self, PyObject* args, PyObject* kwargs )
+{
+	static const char* keywords[] = { "falling_edges", "samples_per_tick", "data_nibbles", "pause_pulse", "legacy_crc", "resync", NULL };
+	PyObject* edges_object;
+	double samples_per_tick;
+	unsigned int data_nibbles = SENT_MAX_DATA_NIBBLES;
+	int pause_pulse = 1;
+	int legacy_crc = 0;
+	int resync = 0;
+
+	if( !PyArg_ParseTupleAndKeywords( args, kwargs, "Od|Ippp", const_cast<char**>( keywords ),
+									  &edges_object, &samples_per_tick, &data_nibbles, &pause_pulse, &legacy_crc, &resync ) )
+	{
+		return NULL;
+	}
+	if( data_nibbles > SENT_MAX_DATA_NIBBLES )
+	{
+		PyErr_SetString( PyExc_ValueError, "data_nibbles should be in range [0:6]" );
+		return NULL;
+	}
+	if( !( samples_per_tick > 0 ) )
+	{
+		PyErr_SetString( PyExc_ValueError, "samples_per_tick should be positive" );
+		return NULL;
+	}
+
+	/* Other integer types (e.g. the int64 result of np.flatnonzero) are converted, once checked for negative values,
+	   as those would wrap around. No copy is made when the edges already are a contiguous uint64 array */
+	PyArrayObject* original = (PyArrayObject*)PyArray_FromAny( edges_object, NULL, 1, 1, 0, NULL );
+	if( original == NULL )
+	{
+		return NULL;
+	}
+	if( !PyArray_ISUNSIGNED( original ) && !PyArray_ISBOOL( original ) && PyArray_SIZE( original ) > 0 )
+	{
+		PyObject* minimum = PyArray_Min( original, 0, NULL );
+		PyObject* zero = PyLong_FromLong( 0 );
+		int negative = ( minimum != NULL && zero != NULL ) ? PyObject_RichCompareBool( minimum, zero, Py_LT ) : -1;
+		Py_XDECREF( minimum );
+		Py_XDECREF( zero );
+		if( negative != 0 )
+		{
+			Py_DECREF( original );
+			if( negative > 0 )
+			{
+				PyErr_SetString( PyExc_ValueError, "falling_edges should not be negative" );
+			}
+			return NULL;
+		}
+	}
+	PyArrayObject* edges = (PyArrayObject*)PyArray_FROMANY( (PyObject*)original, NPY_UINT64, 1, 1, NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST );
+	Py_DECREF( original );
+	if( edges == NULL )
+	{
+		return NULL;
+	}
+	const U64* edge_data = static_cast<const U64*>( PyArray_DATA( edges ) );
+	npy_intp number_of_edges = PyArray_SIZE( edges );
+
+	for( npy_intp i = 1; i < number_of_edges; i++ )
+	{
+		if( edge_data[i] <= edge_data[i - 1] )
+		{
+			Py_DECREF( edges );
+			PyErr_Format( PyExc_ValueError, "falling_edges should be strictly increasing, edge %zd is not", (Py_ssize_t)i );
+			return NULL;
+		}
+	}
+
+	std::vector<SENTMessage>* messages = new( std::nothrow ) std::vector<SENTMessage>();
+	bool out_of_memory = ( messages == NULL );
+
+	Py_BEGIN_ALLOW_THREADS
+	if( !out_of_memory )
+	{
+		try
+		{
+			SENTDecoder decoder;
+			SENTMessage message;
+			decoder.Initialize( samples_per_tick, data_nibbles, pause_pulse != 0, legacy_crc != 0, resync != 0 );
+			/* Every message takes at least its sync, status and CRC pulses */
+			messages->reserve( number_of_edges / ( data_nibbles + 3 ) + 1 );
+			for( npy_intp i = 0; i < number_of_edges; i++ )
+			{
+				if( decoder.AddFallingEdge( edge_data[i], message ) )
+				{
+					messages->push_back( message );
+				}
+			}
+		}
+		catch( std::bad_alloc& )
+		{
+			out_of_memory = true;
+		}
+	}
+	Py_END_ALLOW_THREADS
+
+	Py_DECREF( edges );
+	if( out_of_memory )
+	{
+		delete messages;
+		return PyErr_NoMemory();
+	}
+
+	PyObject* capsule = PyCapsule_New( messages, NULL, destroyMessages );
+	if( capsule == NULL )
+	{
+		delete messages;
+		return NULL;
+	}
+
+	npy_intp dims[1] = { (npy_intp)messages->size() };
+	Py_INCREF( message_descr );
+	PyObject* array = PyArray_NewFromDescr( &PyArray_Type, message_descr, 1, dims, NULL, messages->data(), NPY_ARRAY_CARRAY, NULL );
+	if( array == NULL )
+	{
+		Py_DECREF( capsule );
+		return NULL;
+	}
+	/* The capsule owns the messages and lives as long as the array does */
+	if( PyArray_SetBaseObject( (PyArrayObject*)array, capsule ) < 0 )
+	{
+		Py_DECREF( array );
+		return NULL;
+	}
+	return array;
+}
+
+/** crc4(nibbles, legacy_crc=False)
+ *
+ *  Calculates the SENT CRC4 of the given data nibbles (without status nibble)
+ */
+static PyObject* crc4( PyObject* self, PyObject* args, PyObject* kwargs )
+{
+	static const char* keywords[] = { "nibbles", "legacy_crc", NULL };
+	PyObject* nibbles_object;
+	int legacy_crc = 0;
+
+	if( !PyArg_ParseTupleAndKeywords( args, kwargs, "O|p", const_cast<char**>( keywords ), &nibbles_object, &legacy_crc ) )
+	{
+		return NULL;
+	}
+
+	PyObject* sequence = PySequence_Fast( nibbles_object, "nibbles should be a sequence" );
+	if( sequence == NULL )
+	{
+		return NULL;
+	}
+	Py_ssize_t number_of_nibbles = PySequence_Fast_GET_SIZE( sequence );
+	std::vector<U8> nibbles( number_of_nibbles );
+	for( Py_ssize_t i = 0; i < number_of_nibbles; i++ )
+	{
+		long nibble = PyLong_AsLong( PySequence_Fast_GET_ITEM( sequence, i ) );
+		if( nibble < 0 || nibble > 15 )
+		{
+			Py_DECREF( sequence );
+			if( !PyErr_Occurred() )
+			{
+				PyErr_SetString( PyExc_ValueError, "nibbles should be in range [0:15]" );
+			}
+			return NULL;
+		}
+		nibbles[i] = nibble;
+	}
+	Py_DECREF( sequence );
+
+	return PyLong_FromLong( SENTDecoder::CalculateCRC( nibbles.data(), number_of_nibbles, legacy_crc != 0 ) );
+}
+
+static PyMethodDef methods[] = {
+	{ "decode", (PyCFunction)(void(*)(void))decode, METH_VARARGS | METH_KEYWORDS,
+	  "decode(falling_edges, samples_per_tick, data_nibbles=6, pause_pulse=True, legacy_crc=False, resync=False)\n\n"
+	  "Decode the SENT messages from the sample numbers of the falling edges of a SENT line.\n"
+	  "The edges should be non-negative and strictly increasing, ValueError is raised otherwise.\n"
+	  "Returns a structured array of message_dtype, one element per message, sharing memory with the decoder output.\n"
+	  "The last message is only returned once the sync pulse of the next message was seen." },
+	{ "crc4", (PyCFunction)(void(*)(void))crc4, METH_VARARGS | METH_KEYWORDS,
+	  "crc4(nibbles, legacy_crc=False)\n\n"
+	  "Calculate the SENT CRC4 of the given data nibbles, without status nibble." },
+	{ NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef module = {
+	PyModuleDef_HEAD_INIT,
+	"sent_decoder",
+	"SENT (SAE J2716) decoder, the decoding logic of the SENT analyzer for NumPy arrays of edges",
+	-1,
+	methods
+};
+
+PyMODINIT_FUNC PyInit_sent_decoder( void )
+{
+	import_array();
+
+	message_descr = createMessageDescr();
+	if( message_descr == NULL )
+	{
+		return NULL;
+	}
+
+	PyObject* m = PyModule_Create( &module );
+	if( m == NULL )
+	{
+		return NULL;
+	}
+
+	/* PyModule_AddObject only steals the reference on success */
+	Py_INCREF( message_descr );
+	if( PyModule_AddObject( m, "message_dtype", (PyObject*)message_descr ) < 0 )
+	{
+		Py_DECREF( message_descr );
+		Py_DECREF( m );
+		return NULL;
+	}
+	if( PyModule_AddIntConstant( m, "MESSAGE_VALID", MessageValid ) < 0 ||
+		PyModule_AddIntConstant( m, "MESSAGE_NIBBLE_NUMBER_ERROR", MessageNibbleNumberError ) < 0 ||
+		PyModule_AddIntConstant( m, "MESSAGE_CRC_ERROR", MessageCrcError ) < 0 )
+	{
+		Py_DECREF( m );
+		return NULL;
+	}
+	return m;
+}
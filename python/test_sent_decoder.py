@@ -0,0 +1,145 @@
+"""Tests of the sent_decoder module, run by CTest with the module directory on PYTHONPATH"""
+
+import gc
+import threading
+import unittest
+
+import numpy as np
+
+import sent_decoder
+
+SAMPLES_PER_TICK = 72
+
+
+def make_edges(frames, pause_ticks=100, legacy_crc=False, crc_offset=0):
+    """Falling edges of the given frames (status, data nibbles), followed by the sync pulse that completes the last one"""
+    ticks = []
+    for status, data in frames:
+        crc = (sent_decoder.crc4(data, legacy_crc=legacy_crc) + crc_offset) & 0x0F
+        ticks += [56, 12 + status] + [12 + nibble for nibble in data] + [12 + crc]
+        if pause_ticks:
+            ticks.append(pause_ticks)
+    ticks.append(56)
+    return np.cumsum([1000] + ticks, dtype=np.uint64) * SAMPLES_PER_TICK
+
+
+def make_frames(count, data_nibbles=6):
+    return [(k % 16, [(k * 7 + 3 * i) % 16 for i in range(data_nibbles)]) for k in range(count)]
+
+
+def frame_value(data):
+    value = 0
+    for nibble in data:
+        value = (value << 4) | nibble
+    return value
+
+
+class DecodeTest(unittest.TestCase):
+    def test_values(self):
+        for data_nibbles in range(7):
+            for pause_ticks in (0, 100):
+                frames = make_frames(50, data_nibbles)
+                messages = sent_decoder.decode(make_edges(frames, pause_ticks), SAMPLES_PER_TICK,
+                                               data_nibbles=data_nibbles, pause_pulse=pause_ticks != 0)
+                self.assertEqual(len(messages), len(frames))
+                self.assertTrue((messages["error"] == sent_decoder.MESSAGE_VALID).all())
+                self.assertFalse(messages["resynchronised"].any())
+                self.assertEqual(messages["value"].tolist(), [frame_value(data) for _, data in frames])
+                self.assertEqual(messages["status"].tolist(), [status for status, _ in frames])
+                self.assertEqual(messages["data"][:, :data_nibbles].tolist(), [data for _, data in frames])
+                self.assertTrue((messages["number_of_pulses"] == data_nibbles + (3 if pause_ticks else 2)).all())
+
+    def test_legacy_crc(self):
+        frames = make_frames(20)
+        messages = sent_decoder.decode(make_edges(frames, legacy_crc=True), SAMPLES_PER_TICK, legacy_crc=True)
+        self.assertTrue((messages["error"] == sent_decoder.MESSAGE_VALID).all())
+
+    def test_crc_error(self):
+        messages = sent_decoder.decode(make_edges(make_frames(20), crc_offset=1), SAMPLES_PER_TICK)
+        self.assertEqual(len(messages), 20)
+        self.assertTrue((messages["error"] == sent_decoder.MESSAGE_CRC_ERROR).all())
+
+    def test_nibble_number_error(self):
+        frames = make_frames(3)
+        edges = make_edges(frames)
+        # Leave out the falling edge between the first two data nibbles of the second frame
+        edges = np.delete(edges, len(edges) // 3 + 3)
+        messages = sent_decoder.decode(edges, SAMPLES_PER_TICK)
+        self.assertEqual(messages["error"].tolist(),
+                         [sent_decoder.MESSAGE_VALID, sent_decoder.MESSAGE_NIBBLE_NUMBER_ERROR, sent_decoder.MESSAGE_VALID])
+
+    def test_resync(self):
+        frames = make_frames(3)
+        edges = make_edges(frames)
+        # A glitch 6 ticks into the second data nibble of the second frame
+        glitch = edges[len(edges) // 3 + 3] + 6 * SAMPLES_PER_TICK
+        edges = np.insert(edges, len(edges) // 3 + 4, glitch)
+        messages = sent_decoder.decode(edges, SAMPLES_PER_TICK, resync=True)
+        self.assertTrue((messages["error"] == sent_decoder.MESSAGE_VALID).all())
+        self.assertEqual(messages["resynchronised"].tolist(), [0, 1, 0])
+        self.assertEqual(messages["value"].tolist(), [frame_value(data) for _, data in frames])
+
+    def test_zero_copy(self):
+        edges = make_edges(make_frames(10))
+        messages = sent_decoder.decode(edges, SAMPLES_PER_TICK)
+        # The array does not own its memory, the capsule holding the decoder output does
+        self.assertFalse(messages.flags["OWNDATA"])
+        self.assertEqual(type(messages.base).__name__, "PyCapsule")
+        self.assertEqual(messages.dtype, sent_decoder.message_dtype)
+        values = messages["value"]
+        del messages, edges
+        gc.collect()
+        self.assertEqual(values.tolist(), [frame_value(data) for _, data in make_frames(10)])
+
+    def test_edge_types(self):
+        edges = make_edges(make_frames(10))
+        expected = sent_decoder.decode(edges, SAMPLES_PER_TICK)
+        for converted in (edges.astype(np.int64), edges.tolist()):
+            self.assertTrue((sent_decoder.decode(converted, SAMPLES_PER_TICK) == expected).all())
+
+    def test_empty(self):
+        self.assertEqual(len(sent_decoder.decode(np.array([], dtype=np.uint64), SAMPLES_PER_TICK)), 0)
+
+    def test_invalid_arguments(self):
+        edges = make_edges(make_frames(2))
+        with self.assertRaises(ValueError):
+            sent_decoder.decode(edges, SAMPLES_PER_TICK, data_nibbles=7)
+        with self.assertRaises(ValueError):
+            sent_decoder.decode(edges, 0)
+        with self.assertRaises(ValueError):
+            sent_decoder.crc4([16])
+
+    def test_invalid_edges(self):
+        edges = make_edges(make_frames(2))
+        for invalid in (edges[::-1], np.insert(edges, 5, edges[5]), np.concatenate(([-1], edges.astype(np.int64))),
+                        [-edge for edge in edges.tolist()][::-1]):
+            with self.assertRaises(ValueError):
+                sent_decoder.decode(invalid, SAMPLES_PER_TICK)
+
+    def test_threads(self):
+        # Captures of different lengths, with CRC errors and glitches, so every thread has its own result
+        captures = []
+        for k in range(8):
+            edges = make_edges(make_frames(200 + 50 * k), crc_offset=k % 2)
+            glitch = edges[10 * k + 3] + 6 * SAMPLES_PER_TICK
+            captures.append(np.insert(edges, 10 * k + 4, glitch))
+        serial = [sent_decoder.decode(edges, SAMPLES_PER_TICK, resync=True) for edges in captures]
+
+        results = [None] * len(captures)
+
+        def decode(index):
+            for _ in range(20):
+                results[index] = sent_decoder.decode(captures[index], SAMPLES_PER_TICK, resync=True)
+
+        threads = [threading.Thread(target=decode, args=(index,)) for index in range(len(captures))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for expected, result in zip(serial, results):
+            self.assertEqual(len(result), len(expected))
+            self.assertTrue((result == expected).all())
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -5,14 +5,30 @@
 
 #define STATUS_NIBBLE_NUMBER 	(1)
 #define PAUSE_PULSE_NUMBER 		(crc_nibble_number + 1)
+/* Number of periods of which the smallest one seeds the average message period */
+#define PERIOD_SEED_PERIODS 	(4)
+/* Number of consecutive periods out of tolerance after which the average message period is seeded again */
+#define PERIOD_RESEED_ERRORS 	(8)
+/* Number of cross-check line messages waiting for a partner before the oldest one is dropped */
+#define CROSS_CHECK_QUEUE 		(16)
 
 SENTAnalyzer::SENTAnalyzer()
 :	Analyzer2(),
 	mSettings( new SENTAnalyzerSettings() ),
 	mSimulationInitilized( false ),
-	nibble_counter(0),
 	framelist(),
-	corrected_samples_per_tick(0)
+	last_counter(-1),
+	last_packet_start(0),
+	average_period(0),
+	seed_periods(0),
+	period_errors_in_row(0),
+	invalid_packets(0),
+	context_packets(),
+	context_packets_to_follow(0),
+	mCrossCheckSerial( NULL ),
+	cross_check_messages(),
+	cross_check_window(0),
+	cross_check_alignment_lost(false)
 {
 	SetAnalyzerSettings( mSettings.get() );
 }
@@ -38,141 +54,426 @@ void SENTAnalyzer::SetupResults()
 	}
 }
 
-/** Function for calculation the SENT CRC4
+/** This function will create a new error Frame with the data, error type and timing info provided
  *
- *  @returns 	U8	the calculated CRC4 on the data of the previous SENT frame.
+ *  @param [in] 	data 		The data to be stored in the frame
+ *  @param [in] 	start 		The sample number of the start of the frame
+ *  @param [in] 	end 		The sample number of the end of the frame
+ *  @param [in] 	error_type 	The type of error
  */
-U8 SENTAnalyzer::CalculateCRC()
-{
-	U8 crc4_table [16] = {0, 13, 7, 10, 14, 3, 9, 4, 1, 12, 6, 11, 15, 2, 8, 5};
-	U8 CheckSum16 = 5;
-
-	/* We increment the start pointer by 2 to skip sync and status nibbles.
-	 * In the end condition we decrement the end pointer by 1 to omit the CRC nibble */
-	for(std::vector<Frame>::iterator it = framelist.begin() + 2; it != framelist.end() - (number_of_nibbles - crc_nibble_number); it++)
-	{
-		CheckSum16 = it->mData1 ^ crc4_table[CheckSum16];
-	}
-	if(!mSettings->legacyCRC) {
-		CheckSum16 = 0 ^ crc4_table[CheckSum16];
-	}
-	return CheckSum16;
-}
-
-/** This function will create a new Frame with the data, type and timing info provided and commit it to the current packet
- *
- *  @param [in] 	data 	The data to be stored in the frame
- *  @param [in] 	type 	The pulse type (sync, status, fc, ...)
- *  @param [in] 	start 	The sample number of the start of the frame
- *  @param [in] 	end 	The sample number of the end of the frame
- */
-void SENTAnalyzer::addSENTPulse(U16 data, enum SENTNibbleType type, U64 start, U64 end)
+Frame SENTAnalyzer::makeErrorFrame(U16 data, U64 start, U64 end, SENTErrorType error_type)
 {
 	Frame frame;
 	frame.mData1 = data;
-	frame.mFlags = 0;
-	frame.mType = type;
+	frame.mData2 = 0;
+	frame.mFlags = DISPLAY_AS_ERROR_FLAG | (1 << error_type);
+	frame.mType = Error;
 	frame.mStartingSampleInclusive = start;
 	frame.mEndingSampleInclusive = end;
-	framelist.push_back(frame);
+	return frame;
 }
 
-void SENTAnalyzer::addErrorFrame(U16 data, U64 start, U64 end, SENTErrorType error_type)
+/** This function will commit the given frames as a single packet
+ *
+ *  In errors only mode, packets without error frames are not committed. Instead, the last
+ *  packets are kept in a bounded queue: when a packet with an error comes along, the queued packets
+ *  are committed before it and the packets that follow it are committed as well, up to the
+ *  configured error context. All other packets are only counted. A queued packet is counted as omitted
+ *  until it is committed, so the packets still queued at the end of the capture are counted as well.
+ *
+ *  @param [in] 	frames 	The frames of the packet
+ */
+void SENTAnalyzer::commitPacket(const std::vector<Frame>& frames)
 {
-	Frame frame;
-	frame.mData1 = data;
-	frame.mFlags = DISPLAY_AS_ERROR_FLAG | (1 << error_type);
-	frame.mType = Error;
-	frame.mStartingSampleInclusive = start;
-	frame.mEndingSampleInclusive = end;
+	ReportProgress( frames.back().mEndingSampleInclusive );
+
+	/* Gather the fast channel value and the error status for the value overview */
+	bool has_error = false;
+	bool has_value = false;
+	U32 value = 0;
+	for(std::vector<Frame>::const_iterator it = frames.begin(); it != frames.end(); it++)
+	{
+		if(it->mType == FCNibble)
+		{
+			value = (value << 4) | it->mData1;
+			has_value = true;
+		}
+		else if(it->mType == Error)
+		{
+			has_error = true;
+		}
+	}
+	if((frames.size() != number_of_nibbles) || (frames.at(crc_nibble_number).mType != CRCNibble))
+	{
+		/* The value of a frame that failed the nibble number or CRC check can't be trusted */
+		has_value = false;
+	}
+	if(has_value || has_error)
+	{
+		mResults->GetValueOverview().AddPacket(frames.front().mStartingSampleInclusive, value, has_value, has_error);
+	}
+
+	if(mSettings->errorsOnly)
+	{
+		if(has_error)
+		{
+			for(std::deque< std::vector<Frame> >::iterator packet = context_packets.begin(); packet != context_packets.end(); packet++)
+			{
+				addPacket(*packet);
+			}
+			mResults->GetStatistics().omitted_packets -= context_packets.size();
+			context_packets.clear();
+			context_packets_to_follow = mSettings->errorContextPackets;
+		}
+		else if(context_packets_to_follow > 0)
+		{
+			context_packets_to_follow--;
+		}
+		else if(mSettings->errorContextPackets == 0)
+		{
+			mResults->GetStatistics().omitted_packets++;
+			return;
+		}
+		else
+		{
+			/* Keep the packet as context for a later error. The oldest queued packet is omitted for good */
+			context_packets.push_back(frames);
+			mResults->GetStatistics().omitted_packets++;
+			if(context_packets.size() > mSettings->errorContextPackets)
+			{
+				context_packets.pop_front();
+			}
+			return;
+		}
+	}
+
+	addPacket(frames);
+}
 
-	mResults->AddFrame(frame);
+/** This function will add the given frames to the results as a single packet */
+void SENTAnalyzer::addPacket(const std::vector<Frame>& frames)
+{
+	for(std::vector<Frame>::const_iterator it = frames.begin(); it != frames.end(); it++)
+	{
+		mResults->AddFrame( *it );
+	}
 	mResults->CommitResults();
-	ReportProgress(frame.mEndingSampleInclusive);
+	mResults->CommitPacketAndStartNewPacket();
 }
 
-/** Callback function for detection of sync pulse
+/** Callback function for a message completed by the decoder
  *
- *  This function will do some sanity checks on the data gathered during the
- *  last SENT frame. It will check
+ *  The decoder already checked
  *
  *  - The amount of nibbles
  *  - The CRC
  *
- *  If any of these checks fail, the SENT frame is dropped.
+ *  and tried to realign corrupted messages, if resynchronisation is enabled.
+ *  The pulses of the message are turned into frames. Valid messages are then checked for continuity
+ *  with the previous valid message, and compared with the cross-check line if enabled.
+ *  Messages with a wrong amount of nibbles are committed as a single error frame.
+ *
+ *  @param [in] 	message 	The completed message, its pulses are taken from the decoder
  */
-void SENTAnalyzer::syncPulseDetected()
+void SENTAnalyzer::messageDecoded(const SENTMessage& message)
 {
-	if(framelist.size() == number_of_nibbles)
+	const std::vector<SENTPulse>& pulses = decoder.GetPulses();
+
+	framelist.clear();
+	if(message.error == MessageNibbleNumberError)
 	{
-		U8 expected_crc = CalculateCRC();
-		bool crc_correct = (framelist.at(crc_nibble_number).mData1 == expected_crc);
-		for(std::vector<Frame>::iterator it = framelist.begin(); it != framelist.end(); it++) {
-			if(!crc_correct && (it->mType == CRCNibble)) {
-				addErrorFrame(expected_crc, it->mStartingSampleInclusive, it->mEndingSampleInclusive, CrcError);
-			} else {
-				mResults->AddFrame( *it );
-				mResults->CommitResults();
-				ReportProgress( it->mEndingSampleInclusive );
-			}
+		invalid_packets++;
+		framelist.push_back(makeErrorFrame(message.number_of_pulses + 1, pulses.front().start_sample + 1, pulses.front().end_sample, NibbleNumberError));
+		if(mCrossCheckSerial != NULL)
+		{
+			crossCheck(false);
 		}
-		mResults->CommitPacketAndStartNewPacket();
+		commitPacket(framelist);
+		return;
 	}
-	else if( framelist.size() > 0 )
+
+	for(std::vector<SENTPulse>::const_iterator it = pulses.begin(); it != pulses.end(); it++)
 	{
-		addErrorFrame(framelist.size(), framelist.begin()->mStartingSampleInclusive, framelist.begin()->mEndingSampleInclusive, NibbleNumberError);
-		mResults->CommitPacketAndStartNewPacket();
+		Frame frame;
+		frame.mData1 = it->data;
+		frame.mData2 = 0;
+		frame.mFlags = 0;
+		frame.mType = it->type;
+		frame.mStartingSampleInclusive = it->start_sample + 1;
+		frame.mEndingSampleInclusive = it->end_sample;
+		framelist.push_back(frame);
 	}
-	else /* Framelist is empty. This occurs when the first pulse is already a sync pulse */
+	if(message.resynchronised)
 	{
-		mResults->CancelPacketAndStartNewPacket();
+		framelist.front().mFlags |= DISPLAY_AS_WARNING_FLAG;
 	}
-	framelist.clear();
+
+	bool crc_correct = (message.error == MessageValid);
+	if(crc_correct)
+	{
+		checkContinuity();
+	}
+	else
+	{
+		invalid_packets++;
+		Frame& crc_nibble = framelist.at(crc_nibble_number);
+		crc_nibble.mData1 = SENTDecoder::CalculateCRC(message.data, mSettings->numberOfDataNibbles, mSettings->legacyCRC);
+		crc_nibble.mFlags = DISPLAY_AS_ERROR_FLAG | (1 << CrcError);
+		crc_nibble.mType = Error;
+	}
+	if(mCrossCheckSerial != NULL)
+	{
+		crossCheck(crc_correct);
+	}
+	commitPacket(framelist);
 }
 
-/** Function for correcting the tick time
- *
- *  This function should be called whenever a sync pulse is detected (given the specified clock tolerances)
- *  Then, based on the amount of samples during that period, the amount of samples per tick is recalculated
- *  by dividing this number by the amount of ticks per sync pulse (56).
+/** Function for marking the current packet as erroneous
  *
- *  @param[in] 	number_of_samples	The amount of samples taken during the sync pulse period
+ *  The sync pulse doesn't carry any data, so its frame is replaced by an error frame of the given type.
+ *  Several error types can be set on the same packet.
  */
-void SENTAnalyzer::correctTickTime(U32 number_of_samples)
+void SENTAnalyzer::flagPacketError(SENTErrorType error_type)
 {
-	corrected_samples_per_tick = round(number_of_samples / 56.0);
+	Frame& sync_pulse = framelist.front();
+	sync_pulse.mType = Error;
+	sync_pulse.mFlags |= DISPLAY_AS_ERROR_FLAG | (1 << error_type);
 }
 
-/** Function for determining if the detected pulse is a sync pulse or not
+/** Function for checking the continuity of a valid SENT frame
  *
- *	First, the function checks if the detected pulse is 56 ticks wide.
- *	This narrows the choice down to 2 options: sync pulse and pause pulse
- *	(the other pulses are between 12 and 27 ticks wide)
+ *  This function is called for every valid frame and compares it with the previous valid frame:
  *
- *	Then, in order to determine whether it's a pause pulse or not, we check
- *	whether we were expecting a pause pulse to begin with. If so, we take the
- *	naive approach and assume it's a pause pulse. If not, we say it's a valid
- *	sync pulse.
+ *  - The rolling counter (if configured) should have incremented by exactly one
+ *  - The message period should not deviate more than the configured tolerance from the average period
  *
- *  @retval 	true	The detected pulse is a sync pulse
- *  @retval     false 	The detected pulse is not a sync pulse
+ *  Failing checks are reported as error frames on the sync pulse, and added to the continuity statistics
+ *  together with an estimate of the number of lost frames. Only the previous counter value, the start of
+ *  the previous frame and the average period are kept, so the cost per frame is constant.
+ *
+ *  Packets between both frames that were already reported as CRC or nibble number errors are not counted
+ *  as lost frames again. The average period is seeded with the smallest of the first periods, so a first
+ *  period spanning a lost frame does not skew it, and seeded again when the period stays out of tolerance.
  */
-bool SENTAnalyzer::isPulseSyncPulse(U16 number_of_ticks)
+void SENTAnalyzer::checkContinuity()
 {
-	bool retval = false;
-	/* Sync pulse should be 56 ticks. Given a 20% margin, it should fall in range [45:67] */
-	if(number_of_ticks >= 45 && number_of_ticks <= 67)
+	SENTStatistics& statistics = mResults->GetStatistics();
+	U64 packet_start = framelist.front().mStartingSampleInclusive;
+	U64 lost_frames = 0;
+
+	statistics.valid_packets++;
+
+	if(mSettings->counterNibble != 0)
 	{
-		if ((mSettings->pausePulseEnabled) && (nibble_counter == PAUSE_PULSE_NUMBER))
+		U32 counter = 0;
+		U32 counter_modulus = 1 << (4 * mSettings->counterNibbles);
+		for(U32 i = 0; i < mSettings->counterNibbles; i++)
+		{
+			counter = (counter << 4) | framelist.at(mSettings->counterNibble + i).mData1;
+		}
+		if(last_counter >= 0)
+		{
+			U32 expected_counter = (last_counter + 1) % counter_modulus;
+			U32 skipped_counters = (counter + counter_modulus - expected_counter) % counter_modulus;
+			if(counter == (U32)last_counter || skipped_counters > invalid_packets)
+			{
+				flagPacketError(CounterError);
+				framelist.front().mData1 = expected_counter;
+				statistics.counter_errors++;
+				/* A repeated counter value, or one that went backwards (a jump of at least half the counter range beyond
+				   the invalid packets, as in serial number arithmetic), is an error, but no frames were lost */
+				if(counter != (U32)last_counter && skipped_counters - invalid_packets < counter_modulus / 2)
+				{
+					lost_frames = skipped_counters - invalid_packets;
+				}
+			}
+		}
+		last_counter = counter;
+	}
+
+	if(last_packet_start != 0)
+	{
+		U64 period = packet_start - last_packet_start;
+		/* A period spanning invalid packets is not a message period */
+		if(invalid_packets == 0)
+		{
+			if(statistics.min_period == 0 || period < statistics.min_period)
+			{
+				statistics.min_period = period;
+			}
+			if(period > statistics.max_period)
+			{
+				statistics.max_period = period;
+			}
+		}
+
+		if(mSettings->periodTolerancePercent == 0)
+		{
+			/* Period check disabled */
+		}
+		else if(seed_periods < PERIOD_SEED_PERIODS)
+		{
+			if(invalid_packets == 0)
+			{
+				if(seed_periods == 0 || period < average_period)
+				{
+					average_period = period;
+				}
+				seed_periods++;
+			}
+		}
+		else if(invalid_packets != 0)
+		{
+			/* Only frames beyond the invalid packets are lost */
+			U64 spanned_periods = round(period / average_period);
+			if(spanned_periods > invalid_packets + 1)
+			{
+				flagPacketError(PeriodError);
+				framelist.front().mData2 = round((double)period / decoder.GetSamplesPerTick());
+				statistics.period_errors++;
+				if(mSettings->counterNibble == 0)
+				{
+					lost_frames = spanned_periods - invalid_packets - 1;
+				}
+			}
+		}
+		else if(fabs(period - average_period) > average_period * mSettings->periodTolerancePercent / 100.0)
 		{
-			retval = false;
+			flagPacketError(PeriodError);
+			framelist.front().mData2 = round((double)period / decoder.GetSamplesPerTick());
+			statistics.period_errors++;
+			/* Without rolling counter, the number of lost frames can only be estimated from the period */
+			if(mSettings->counterNibble == 0 && period > average_period)
+			{
+				lost_frames = round(period / average_period) - 1;
+			}
+			/* The message period itself has changed, measure it again */
+			period_errors_in_row++;
+			if(period_errors_in_row >= PERIOD_RESEED_ERRORS)
+			{
+				seed_periods = 0;
+				period_errors_in_row = 0;
+			}
 		}
 		else
 		{
-			retval = true;
+			/* Only periods within tolerance update the average, so a gap doesn't skew it */
+			average_period += (period - average_period) / 16.0;
+			period_errors_in_row = 0;
+		}
+	}
+	last_packet_start = packet_start;
+	invalid_packets = 0;
+
+	statistics.lost_frames += lost_frames;
+}
+
+/** Function for decoding the cross-check line up to the given sample
+ *
+ *  Both lines are decoded in a single pass with a streaming merge: the cross-check line is kept ahead
+ *  of the main line by the cross-check window, so the partner of a main line message is always decoded
+ *  by the time that message is checked. Messages with an error are queued as well, so they still take the place
+ *  of their partner, and counted. The queue is bounded.
+ *
+ *  @param [in] 	sample 	The sample number up to which the cross-check line is decoded
+ */
+void SENTAnalyzer::advanceCrossCheckLine(U64 sample)
+{
+	while(mCrossCheckSerial->WouldAdvancingToAbsPositionCauseTransition(sample))
+	{
+		mCrossCheckSerial->AdvanceToNextEdge();
+		if(mCrossCheckSerial->GetBitState() != BIT_LOW)
+		{
+			continue;
+		}
+
+		SENTMessage message;
+		if(cross_check_decoder.AddFallingEdge(mCrossCheckSerial->GetSampleNumber(), message))
+		{
+			if(message.error != MessageValid)
+			{
+				mResults->GetStatistics().cross_check_line_errors++;
+			}
+			cross_check_messages.push_back(message);
+			if(cross_check_messages.size() > CROSS_CHECK_QUEUE)
+			{
+				cross_check_messages.pop_front();
+				cross_check_alignment_lost = true;
+			}
+		}
+	}
+}
+
+/** Function for comparing the current packet with its partner on the cross-check line
+ *
+ *  The partner is the oldest queued cross-check line message that starts within the cross-check window
+ *  of the packet. Older messages have no partner anymore and are dropped.
+ *
+ *  - The values differ more than the tolerance (after complementing, if configured): cross-check error
+ *  - The packet has no partner, or cross-check line messages were dropped: alignment error
+ *
+ *  A partner with a nibble number or CRC error is dropped without any comparison, it was counted when it was decoded.
+ *
+ *  @param [in] 	packet_valid 	Whether the packet passed the nibble number and CRC checks. If not, its
+ *  								partner is dropped without any comparison, as the error is already reported.
+ */
+void SENTAnalyzer::crossCheck(bool packet_valid)
+{
+	SENTStatistics& statistics = mResults->GetStatistics();
+	U64 packet_start = framelist.front().mStartingSampleInclusive;
+
+	while(!cross_check_messages.empty() && (cross_check_messages.front().start_sample + cross_check_window < packet_start))
+	{
+		cross_check_messages.pop_front();
+		cross_check_alignment_lost = true;
+	}
+
+	bool has_partner = !cross_check_messages.empty() && (cross_check_messages.front().start_sample <= packet_start + cross_check_window);
+	if(!packet_valid)
+	{
+		if(has_partner)
+		{
+			cross_check_messages.pop_front();
+		}
+		return;
+	}
+
+	if(has_partner && (cross_check_messages.front().error != MessageValid))
+	{
+		cross_check_messages.pop_front();
+	}
+	else if(has_partner)
+	{
+		U32 value = 0;
+		for(U16 i = STATUS_NIBBLE_NUMBER + 1; i < crc_nibble_number; i++)
+		{
+			value = (value << 4) | framelist[i].mData1;
+		}
+		U32 partner_value = cross_check_messages.front().value;
+		if(mSettings->crossCheckMode == CrossCheckComplementary)
+		{
+			partner_value = ((1 << (4 * mSettings->numberOfDataNibbles)) - 1) - partner_value;
+		}
+		U32 difference = (value > partner_value) ? (value - partner_value) : (partner_value - value);
+		if(difference > mSettings->crossCheckTolerance)
+		{
+			flagPacketError(CrossCheckError);
+			framelist.front().mData2 = (framelist.front().mData2 & 0xFFFFFFFF) | ((U64)cross_check_messages.front().value << 32);
+			statistics.cross_check_errors++;
 		}
+		cross_check_messages.pop_front();
+	}
+	else
+	{
+		cross_check_alignment_lost = true;
+	}
+
+	if(cross_check_alignment_lost)
+	{
+		flagPacketError(AlignmentError);
+		statistics.alignment_errors++;
+		cross_check_alignment_lost = false;
 	}
-	return retval;
 }
 
 /** Main signal processing function
@@ -195,10 +496,6 @@ void SENTAnalyzer::WorkerThread()
 	/* Based on the configured tick time and the sampling rate, determine the amount of samples per tick */
 	U32 theoretical_samples_per_ticks = mSampleRateHz * (mSettings->tick_time_half_us / 2.0) / 1000000;
 
-	/* This is initialized to the theoretical samples per tick, and is adjusted on every
-	 * received sync pulse */
-	corrected_samples_per_tick = theoretical_samples_per_ticks;
-
 	/* Request the channel we are using for the analysis */
 	mSerial = GetAnalyzerChannelData( mSettings->mInputChannel );
 
@@ -207,85 +504,62 @@ void SENTAnalyzer::WorkerThread()
 		mSerial->AdvanceToNextEdge();
 	mSerial->AdvanceToNextEdge();
 
-	U64 starting_sample;
+	/* The decoder corrects the tick time on every received sync pulse */
+	SENTMessage message;
+	decoder.Initialize(theoretical_samples_per_ticks, mSettings->numberOfDataNibbles, mSettings->pausePulseEnabled, mSettings->legacyCRC, mSettings->resyncEnabled);
+	decoder.AddFallingEdge(mSerial->GetSampleNumber(), message);
 
 	framelist = std::vector<Frame>();
-	nibble_counter = 0;
 
-	for( ; ; )
+	/* Continuity check state */
+	last_counter = -1;
+	last_packet_start = 0;
+	average_period = 0;
+	seed_periods = 0;
+	period_errors_in_row = 0;
+	invalid_packets = 0;
+
+	/* Level 0 of the value overview spans the smallest power of two number of samples covering 1024 ticks */
+	U32 overview_bucket_shift = 0;
+	while((1ull << overview_bucket_shift) < 1024ull * theoretical_samples_per_ticks)
 	{
-		enum SENTNibbleType nibble_type = Unknown;
+		overview_bucket_shift++;
+	}
+	mResults->GetValueOverview().Initialize(overview_bucket_shift);
 
-		/* We capture the sample number on the falling edge, for reference */
-		starting_sample = mSerial->GetSampleNumber();
-		/* Then, we advance 2 edges, so we end up on the next falling edge */
+	/* The cross-check line is decoded along with the main line, by a decoder of its own */
+	mCrossCheckSerial = NULL;
+	if(mSettings->crossCheckMode != CrossCheckOff)
+	{
+		mCrossCheckSerial = GetAnalyzerChannelData( mSettings->mCrossCheckChannel );
+		cross_check_decoder.Initialize(theoretical_samples_per_ticks, mSettings->numberOfDataNibbles, mSettings->pausePulseEnabled, mSettings->legacyCRC, mSettings->resyncEnabled);
+		cross_check_messages.clear();
+		cross_check_window = mSettings->crossCheckWindowTicks * theoretical_samples_per_ticks;
+		cross_check_alignment_lost = false;
+	}
+
+	/* Errors only mode state */
+	context_packets.clear();
+	context_packets_to_follow = 0;
+
+	for( ; ; )
+	{
+		/* Advance 2 edges, so we end up on the next falling edge */
 		mSerial->AdvanceToNextEdge();
 		mSerial->AdvanceToNextEdge();
 
-		/* Calculate the number of samples in this period */
-		U32 number_of_samples = mSerial->GetSampleNumber() - starting_sample;
-		/* Now, based on the difference in amount of samples between the current falling edge
-		   and the reference one, we can determine the amount of ticks that have passed */
-		U16 theoretical_number_of_ticks = round((float)number_of_samples / theoretical_samples_per_ticks);
-		U16 corrected_number_of_ticks = round((float)number_of_samples / corrected_samples_per_tick);
-
-		/* Based on the amount of ticks and a nibble counter, we can attempt to determine
-   		   what type of pulse was encountered */
-
-		/* First check if the detected pulse is a sync pulse
-		   As a sync pulse indicates the start of a new SENT frame, the previous
-		   Packet is closed and committed and a new Packet is started.
-		   */
-		if(isPulseSyncPulse(theoretical_number_of_ticks))
+		/* Keep the cross-check line ahead of this line by the cross-check window */
+		if(mCrossCheckSerial != NULL)
 		{
-			/* If it's a valid sync pulse, calculate the corrected tick time */
-			correctTickTime(number_of_samples);
-			/* Then close the previous frame and check if it was valid */
-			syncPulseDetected();
-			nibble_type = SyncPulse;
-			corrected_number_of_ticks = 56;
-			nibble_counter = 0;
+			advanceCrossCheckLine(mSerial->GetSampleNumber() + cross_check_window);
 		}
-		/* Then we check if the nibble counter indicates that we're expecting a pause pulse.
-		   The pause pulse can take a larger range of sizes than any of the other pulse types,
-		   so no sense in checking for the amount of ticks */
-		else if (nibble_counter == PAUSE_PULSE_NUMBER)
-		{
-			nibble_type = PausePulse;
-		}
-		/* If not a pause pulse of sync pulse, it must be a data-carrying nibble.
-		   The size range for these pulses is limited, so we check that first
-		   Then, we check the nibble counter to see which type of nibble is expected */
-		else if (corrected_number_of_ticks > 11 && corrected_number_of_ticks < 28)
+
+		/* The pulse ending on this edge is classified by the decoder. A message is completed
+		   on the sync pulse of the next one, and is then checked and committed as a single packet */
+		if(decoder.AddFallingEdge(mSerial->GetSampleNumber(), message))
 		{
-			if(nibble_counter == STATUS_NIBBLE_NUMBER)
-			{
-				nibble_type = StatusNibble;
-				/* We extract the actual data by subtracting the number of ticks by 12 */
-				corrected_number_of_ticks -= 12;
-			}
-			else if (nibble_counter > STATUS_NIBBLE_NUMBER && nibble_counter < crc_nibble_number)
-			{
-				nibble_type = FCNibble;
-				/* We extract the actual data by subtracting the number of ticks by 12 */
-				corrected_number_of_ticks -= 12;
-			}
-			else if(nibble_counter == crc_nibble_number)
-			{
-				nibble_type = CRCNibble;
-				/* We extract the actual data by subtracting the number of ticks by 12 */
-				corrected_number_of_ticks -= 12;
-			}
+			messageDecoded(message);
 		}
-		/* If none of the above conditions are met, the frame is marked as "unknown" */
-		else {
-			nibble_counter = 0;
-		} /* Do nothing. No valid frame was detected */
-
-		nibble_counter++;
-
-		/* Commit the frame to the database and to the current packet */
-		addSENTPulse(corrected_number_of_ticks, nibble_type, starting_sample + 1, mSerial->GetSampleNumber());
 	}
 }
 
@@ -2,8 +2,11 @@
 #define SENT_ANALYZER_H
 
 #include <Analyzer.h>
+#include <deque>
+#include <vector>
 #include "SENTAnalyzerResults.h"
 #include "SENTSimulationDataGenerator.h"
+#include "SENTDecoder.h"
 
 class SENTAnalyzerSettings;
 class ANALYZER_EXPORT SENTAnalyzer : public Analyzer2
@@ -33,19 +36,33 @@ protected: //vars
 	U32 mSampleRateHz;
 	U32 mStartOfStopBitOffset;
 	U32 mEndOfStopBitOffset;
-	U8 nibble_counter;
 	U16 crc_nibble_number;
 	U16 number_of_nibbles;
+	SENTDecoder decoder;
 	std::vector<Frame> framelist;
-	U32 corrected_samples_per_tick;
+	S32 last_counter;
+	U64 last_packet_start;
+	double average_period;
+	U32 seed_periods;
+	U32 period_errors_in_row;
+	U32 invalid_packets;
+	std::deque< std::vector<Frame> > context_packets;
+	U32 context_packets_to_follow;
+	AnalyzerChannelData* mCrossCheckSerial;
+	SENTDecoder cross_check_decoder;
+	std::deque<SENTMessage> cross_check_messages;
+	U64 cross_check_window;
+	bool cross_check_alignment_lost;
 
-	void syncPulseDetected();
-	void correctTickTime(U32 number_of_samples);
-	U8 CalculateCRC();
-	bool isPulseSyncPulse(U16 number_of_ticks);
+	void messageDecoded(const SENTMessage& message);
+	void flagPacketError(SENTErrorType error_type);
+	void checkContinuity();
+	void advanceCrossCheckLine(U64 sample);
+	void crossCheck(bool packet_valid);
 private:
-	void addSENTPulse(U16 ticks, enum SENTNibbleType type, U64 start, U64 end);
-	void addErrorFrame(U16 data, U64 start, U64 end, SENTErrorType error_type);
+	Frame makeErrorFrame(U16 data, U64 start, U64 end, SENTErrorType error_type);
+	void commitPacket(const std::vector<Frame>& frames);
+	void addPacket(const std::vector<Frame>& frames);
 };
 
 extern "C" ANALYZER_EXPORT const char* __cdecl GetAnalyzerName();
@@ -6,6 +6,11 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <thread>
+#include <functional>
+#include <stdio.h>
+
+#define EXPORT_PACKETS_PER_RANGE	(4096)
 
 std::map<enum SENTNibbleType, std::string> TypeMap;
 
@@ -15,6 +20,7 @@ SENTAnalyzerResults::SENTAnalyzerResults( SENTAnalyzer* analyzer, SENTAnalyzerSe
 	mAnalyzer( analyzer )
 {
 	InitializeTypeMap();
+	mStatistics = SENTStatistics();
 }
 
 SENTAnalyzerResults::~SENTAnalyzerResults()
@@ -41,6 +47,9 @@ std::string SENTAnalyzerResults::FrameToString(Frame frame, DisplayBase display_
 	{
 		case SyncPulse:
 			ss << "Sync pulse: ";
+			if((frame.mFlags & DISPLAY_AS_WARNING_FLAG) != 0u){
+				ss << "(resynchronised)";
+			}
 			break;
 		case StatusNibble:
 			AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 4, number_str, 128 );
@@ -69,6 +78,17 @@ std::string SENTAnalyzerResults::FrameToString(Frame frame, DisplayBase display_
 			} else if((frame.mFlags & (1 << CrcError)) != 0u){
 				AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 4, number_str, 128 );
 				ss << "Error. Wrong CRC: expected: " << number_str;
+			} else if((frame.mFlags & (1 << CounterError)) != 0u){
+				AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 8, number_str, 128 );
+				ss << "Error. Rolling counter skipped: expected: " << number_str;
+			} else if((frame.mFlags & (1 << PeriodError)) != 0u){
+				AnalyzerHelpers::GetNumberString( frame.mData2 & 0xFFFFFFFF, display_base, 16, number_str, 128 );
+				ss << "Error. Message period out of bounds: ticks: " << number_str;
+			} else if((frame.mFlags & (1 << CrossCheckError)) != 0u){
+				AnalyzerHelpers::GetNumberString( frame.mData2 >> 32, display_base, 4 * mSettings->numberOfDataNibbles, number_str, 128 );
+				ss << "Error. Cross-check mismatch: cross-check line value: " << number_str;
+			} else if((frame.mFlags & (1 << AlignmentError)) != 0u){
+				ss << "Error. Cross-check alignment lost";
 			}
 			break;
 		}
@@ -85,48 +105,229 @@ void SENTAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& channel,
 	AddResultString(FrameToString(frame, display_base).c_str());
 }
 
+/** Formats a range of packets into a text buffer, in the export file format
+ *
+ *  This function only works on the frames handed to it, so it can safely run on a worker thread
+ *
+ *  @param [in] 	frames 			The frames of all packets in the range, in order
+ *  @param [in] 	packet_ends 	For each packet in the range, the index in frames one past its last frame
+ *  @param [in] 	trigger_sample 	The trigger sample, used as time reference
+ *  @param [in] 	sample_rate 	The sample rate of the capture
+ *  @param [in] 	display_base 	The display base of the exported numbers
+ *  @param [out] 	buffer 			The formatted text
+ */
+void SENTAnalyzerResults::FormatExportRange(const std::vector<Frame>& frames, const std::vector<U64>& packet_ends, U64 trigger_sample, U32 sample_rate, DisplayBase display_base, std::string& buffer)
+{
+	char time_str[128];
+	char number_str[128];
+	U64 frameid = 0;
+
+	buffer.clear();
+	/* A formatted frame takes less than 64 characters, reserving up front avoids regrowing the buffer */
+	buffer.reserve(frames.size() * 64);
+
+	for(std::vector<U64>::const_iterator packet_end = packet_ends.begin(); packet_end != packet_ends.end(); packet_end++)
+	{
+		for( ; frameid < *packet_end; frameid++)
+		{
+			const Frame& frame = frames[frameid];
+			AnalyzerHelpers::GetTimeString( frame.mStartingSampleInclusive, trigger_sample, sample_rate, time_str, 128 );
+			AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 8, number_str, 128 );
+
+			buffer.append(time_str);
+			buffer.append(", ");
+			buffer.append(number_str);
+			buffer.append(", ");
+			buffer.append(TypeMap.at((enum SENTNibbleType)frame.mType));
+			buffer.append("\n");
+		}
+		buffer.append("------, ------, -----\n");
+	}
+}
+
+/** Export function
+ *
+ *  Formatting the frames is the expensive part of the export, so the packets are split in ranges of
+ *  EXPORT_PACKETS_PER_RANGE packets which are formatted in parallel, one range per thread.
+ *  The frames themselves are fetched from the results on the calling thread only.
+ *  The formatted ranges are then written to the file in order, using a single large write per range.
+ *  Progress is reported and cancellation is checked once per batch of ranges.
+ */
 void SENTAnalyzerResults::GenerateExportFile( const char* file, DisplayBase display_base, U32 export_type_user_id )
 {
-	U32 number_of_packets = GetNumPackets();
+	if( export_type_user_id == 1 )
+	{
+		GenerateContinuityReport( file );
+		return;
+	}
+	if( export_type_user_id == 2 )
+	{
+		GenerateValueOverview( file, display_base );
+		return;
+	}
+
+	U64 number_of_packets = GetNumPackets();
 	U64 trigger_sample = mAnalyzer->GetTriggerSample();
 	U32 sample_rate = mAnalyzer->GetSampleRate();
 
+	U32 number_of_ranges = std::thread::hardware_concurrency();
+	if(number_of_ranges == 0)
+	{
+		number_of_ranges = 1;
+	}
+
+	std::vector< std::vector<Frame> > range_frames(number_of_ranges);
+	std::vector< std::vector<U64> > range_packet_ends(number_of_ranges);
+	std::vector<std::string> range_buffers(number_of_ranges);
+
 	std::ofstream file_stream( file, std::ios::out );
 
-	file_stream << "Time [s],Value" << std::endl;
+	file_stream << "Time [s],Value\n";
 
-	for( U32 i=0; i < number_of_packets; i++ )
+	U64 packetid = 0;
+	while( packetid < number_of_packets )
 	{
-		U64 frameid;
-		U64 frameid_end;
+		/* Fetch the frames of the next batch of packets, one range at a time */
+		U32 ranges_in_batch = 0;
+		for( ; (ranges_in_batch < number_of_ranges) && (packetid < number_of_packets); ranges_in_batch++)
+		{
+			std::vector<Frame>& frames = range_frames[ranges_in_batch];
+			std::vector<U64>& packet_ends = range_packet_ends[ranges_in_batch];
+			frames.clear();
+			packet_ends.clear();
 
-		GetFramesContainedInPacket(i, &frameid, &frameid_end);
+			for(U32 i = 0; (i < EXPORT_PACKETS_PER_RANGE) && (packetid < number_of_packets); i++, packetid++)
+			{
+				U64 frameid;
+				U64 frameid_end;
 
-		while (frameid <= frameid_end)
-		{
-			Frame frame = GetFrame(frameid);
-			char time_str[128];
-			AnalyzerHelpers::GetTimeString( frame.mStartingSampleInclusive, trigger_sample, sample_rate, time_str, 128 );
+				GetFramesContainedInPacket(packetid, &frameid, &frameid_end);
 
-			char number_str[128];
-			AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 8, number_str, 128 );
+				for( ; frameid <= frameid_end; frameid++)
+				{
+					frames.push_back(GetFrame(frameid));
+				}
+				packet_ends.push_back(frames.size());
+			}
+		}
 
-			file_stream << time_str << ", " << number_str << ", " << TypeMap[(enum SENTNibbleType)frame.mType] << std::endl;
+		/* Format the ranges in parallel. The calling thread takes the first range itself */
+		std::vector<std::thread> workers;
+		for(U32 range = 1; range < ranges_in_batch; range++)
+		{
+			workers.push_back(std::thread(&SENTAnalyzerResults::FormatExportRange, std::cref(range_frames[range]), std::cref(range_packet_ends[range]),
+										  trigger_sample, sample_rate, display_base, std::ref(range_buffers[range])));
+		}
+		FormatExportRange(range_frames[0], range_packet_ends[0], trigger_sample, sample_rate, display_base, range_buffers[0]);
+		for(std::vector<std::thread>::iterator worker = workers.begin(); worker != workers.end(); worker++)
+		{
+			worker->join();
+		}
 
-			frameid++;
+		/* Write the ranges in order */
+		for(U32 range = 0; range < ranges_in_batch; range++)
+		{
+			file_stream.write(range_buffers[range].data(), range_buffers[range].size());
 		}
 
-		if( UpdateExportProgressAndCheckForCancel( i, number_of_packets ) == true )
+		if( UpdateExportProgressAndCheckForCancel( packetid, number_of_packets ) == true )
 		{
 			file_stream.close();
 			return;
 		}
-		file_stream << "------, ------, -----" << std::endl;
 	}
 
 	file_stream.close();
 }
 
+/** Writes the summary of the continuity checks to a file */
+void SENTAnalyzerResults::GenerateContinuityReport( const char* file )
+{
+	U32 sample_rate = mAnalyzer->GetSampleRate();
+	char min_period_str[128];
+	char max_period_str[128];
+	AnalyzerHelpers::GetTimeString( mStatistics.min_period, 0, sample_rate, min_period_str, 128 );
+	AnalyzerHelpers::GetTimeString( mStatistics.max_period, 0, sample_rate, max_period_str, 128 );
+
+	std::ofstream file_stream( file, std::ios::out );
+
+	file_stream << "Valid packets," << mStatistics.valid_packets << "\n";
+	file_stream << "Rolling counter errors," << mStatistics.counter_errors << "\n";
+	file_stream << "Message period errors," << mStatistics.period_errors << "\n";
+	file_stream << "Lost frames," << mStatistics.lost_frames << "\n";
+	file_stream << "Minimum message period [s]," << min_period_str << "\n";
+	file_stream << "Maximum message period [s]," << max_period_str << "\n";
+	file_stream << "Packets omitted (errors only)," << mStatistics.omitted_packets << "\n";
+	file_stream << "Cross-check mismatches," << mStatistics.cross_check_errors << "\n";
+	file_stream << "Cross-check alignment errors," << mStatistics.alignment_errors << "\n";
+	file_stream << "Cross-check line errors," << mStatistics.cross_check_line_errors << "\n";
+
+	file_stream.close();
+}
+
+/** Writes the levels of the value overview to a file
+ *
+ *  All kept levels are exported, from coarse to fine. None of them holds more than OVERVIEW_BUCKETS buckets.
+ *  This is enough to render an overview of the whole capture, without reading back any frame.
+ */
+void SENTAnalyzerResults::GenerateValueOverview( const char* file, DisplayBase display_base )
+{
+	U64 trigger_sample = mAnalyzer->GetTriggerSample();
+	U32 sample_rate = mAnalyzer->GetSampleRate();
+	U32 value_bits = 4 * mSettings->numberOfDataNibbles;
+	std::vector<SENTValueBucket> buckets;
+	std::string buffer;
+
+	std::ofstream file_stream( file, std::ios::out );
+
+	file_stream << "Level,Start [s],End [s],Messages,Min,Max,Mean,Errors\n";
+
+	S32 finest_level = mValueOverview.GetFinestLevel();
+	for( S32 level = OVERVIEW_LEVELS - 1; level >= finest_level; level-- )
+	{
+		mValueOverview.GetLevel( level, buckets );
+
+		U64 bucket_samples = mValueOverview.GetBucketSamples( level );
+		buffer.clear();
+		for( std::vector<SENTValueBucket>::iterator bucket = buckets.begin(); bucket != buckets.end(); bucket++ )
+		{
+			char start_str[128];
+			char end_str[128];
+			char min_str[128];
+			char max_str[128];
+			char line[640];
+			AnalyzerHelpers::GetTimeString( bucket->index * bucket_samples, trigger_sample, sample_rate, start_str, 128 );
+			AnalyzerHelpers::GetTimeString( ( bucket->index + 1 ) * bucket_samples, trigger_sample, sample_rate, end_str, 128 );
+			AnalyzerHelpers::GetNumberString( bucket->min, display_base, value_bits, min_str, 128 );
+			AnalyzerHelpers::GetNumberString( bucket->max, display_base, value_bits, max_str, 128 );
+
+			if( bucket->messages > 0 )
+			{
+				snprintf( line, sizeof( line ), "%d,%s,%s,%u,%s,%s,%.3f,%u\n", level, start_str, end_str, bucket->messages, min_str, max_str,
+						  bucket->sum / bucket->messages, bucket->errors );
+			}
+			else
+			{
+				snprintf( line, sizeof( line ), "%d,%s,%s,0,,,,%u\n", level, start_str, end_str, bucket->errors );
+			}
+			buffer.append( line );
+		}
+		file_stream.write( buffer.data(), buffer.size() );
+	}
+
+	file_stream.close();
+}
+
+SENTStatistics& SENTAnalyzerResults::GetStatistics()
+{
+	return mStatistics;
+}
+
+SENTValueOverview& SENTAnalyzerResults::GetValueOverview()
+{
+	return mValueOverview;
+}
+
 void SENTAnalyzerResults::GenerateFrameTabularText( U64 frame_index, DisplayBase display_base )
 {
 	ClearTabularText();
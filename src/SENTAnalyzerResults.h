@@ -2,12 +2,31 @@
 #define SENT_ANALYZER_RESULTS
 
 #include <AnalyzerResults.h>
+#include "SENTDecoder.h"
+#include "SENTValueOverview.h"
+#include <string>
+#include <vector>
 
 class SENTAnalyzer;
 class SENTAnalyzerSettings;
 
-enum SENTNibbleType { SyncPulse, StatusNibble, FCNibble, CRCNibble, PausePulse, Unknown, Error};
-enum SENTErrorType { NibbleNumberError, CrcError};
+/* Error types are stored as bits in the frame flags, next to the display flags (bits 6 and 7), so there can be no more than 6 */
+enum SENTErrorType { NibbleNumberError, CrcError, CounterError, PeriodError, CrossCheckError, AlignmentError};
+
+/* Summary counters, gathered over the whole capture */
+struct SENTStatistics
+{
+	U64 valid_packets;
+	U64 counter_errors;
+	U64 period_errors;
+	U64 lost_frames;
+	U64 min_period;
+	U64 max_period;
+	U64 omitted_packets;
+	U64 cross_check_errors;
+	U64 alignment_errors;
+	U64 cross_check_line_errors;
+};
 
 class SENTAnalyzerResults : public AnalyzerResults
 {
@@ -22,11 +41,19 @@ public:
 	virtual void GeneratePacketTabularText( U64 packet_id, DisplayBase display_base );
 	virtual void GenerateTransactionTabularText( U64 transaction_id, DisplayBase display_base );
 
+	SENTStatistics& GetStatistics();
+	SENTValueOverview& GetValueOverview();
+
 protected: //functions
+	void GenerateContinuityReport( const char* file );
+	void GenerateValueOverview( const char* file, DisplayBase display_base );
+	static void FormatExportRange(const std::vector<Frame>& frames, const std::vector<U64>& packet_ends, U64 trigger_sample, U32 sample_rate, DisplayBase display_base, std::string& buffer);
 
 protected:  //vars
 	SENTAnalyzerSettings* mSettings;
 	SENTAnalyzer* mAnalyzer;
+	SENTStatistics mStatistics;
+	SENTValueOverview mValueOverview;
 	std::string FrameToString(Frame frame, DisplayBase display_base);
 	void InitializeTypeMap(void);
 };
@@ -7,7 +7,18 @@ SENTAnalyzerSettings::SENTAnalyzerSettings()
 	tick_time_half_us(3),
 	pausePulseEnabled(true),
 	legacyCRC(false),
-	numberOfDataNibbles(6)
+	numberOfDataNibbles(6),
+	resyncEnabled(false),
+	counterNibble(0),
+	counterNibbles(1),
+	periodTolerancePercent(0),
+	errorsOnly(false),
+	errorContextPackets(2),
+	crossCheckMode(CrossCheckOff),
+	mCrossCheckChannel( UNDEFINED_CHANNEL ),
+	crossCheckTolerance(0),
+	crossCheckWindowTicks(100),
+	simulationScenario(SimulationFixedFrames)
 {
 	mInputChannelInterface.reset( new AnalyzerSettingInterfaceChannel() );
 	mInputChannelInterface->SetTitleAndTooltip( "Serial", "Standard SENT (SAE J2716)" );
@@ -33,18 +44,101 @@ SENTAnalyzerSettings::SENTAnalyzerSettings()
 	legacyCRCInterface->SetTitleAndTooltip( "Legacy CRC",  "Specify whether the legacy crc calculation should be used or not" );
 	legacyCRCInterface->SetValue(legacyCRC);
 
+	resyncInterface.reset( new AnalyzerSettingInterfaceBool() );
+	resyncInterface->SetTitleAndTooltip( "Resynchronisation",  "Specify whether frames with a corrupted nibble should be recovered by trying alternative alignments against the CRC" );
+	resyncInterface->SetValue(resyncEnabled);
+
+	counterNibbleInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	counterNibbleInterface->SetTitleAndTooltip( "Rolling counter nibble", "Specify the position of the (most significant) rolling counter nibble: 1 for the status nibble, 2 to 7 for fast channel nibbles 1 to 6, 0 to disable the rolling counter check" );
+	counterNibbleInterface->SetMax( 7 );
+	counterNibbleInterface->SetMin( 0 );
+	counterNibbleInterface->SetInteger( counterNibble );
+
+	counterNibblesInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	counterNibblesInterface->SetTitleAndTooltip( "Rolling counter nibbles", "Specify the number of nibbles of the rolling counter, most significant nibble first" );
+	counterNibblesInterface->SetMax( 2 );
+	counterNibblesInterface->SetMin( 1 );
+	counterNibblesInterface->SetInteger( counterNibbles );
+
+	periodToleranceInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	periodToleranceInterface->SetTitleAndTooltip( "Message period tolerance (%)", "Specify the allowed deviation of the message period from its average, 0 to disable the message period check" );
+	periodToleranceInterface->SetMax( 100 );
+	periodToleranceInterface->SetMin( 0 );
+	periodToleranceInterface->SetInteger( periodTolerancePercent );
+
+	errorsOnlyInterface.reset( new AnalyzerSettingInterfaceBool() );
+	errorsOnlyInterface->SetTitleAndTooltip( "Errors only", "Specify whether only the packets around errors should be stored. Other packets are only counted" );
+	errorsOnlyInterface->SetValue(errorsOnly);
+
+	errorContextInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	errorContextInterface->SetTitleAndTooltip( "Error context (packets)", "Specify the number of packets to store before and after an error, in errors only mode" );
+	errorContextInterface->SetMax( 100 );
+	errorContextInterface->SetMin( 0 );
+	errorContextInterface->SetInteger( errorContextPackets );
+
+	crossCheckModeInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	crossCheckModeInterface->SetTitleAndTooltip( "Cross-check", "Specify whether the fast channel value should be compared with the one of a redundant SENT line" );
+	crossCheckModeInterface->AddNumber( CrossCheckOff, "Off", "No cross-check" );
+	crossCheckModeInterface->AddNumber( CrossCheckEqual, "Equal", "The redundant line sends the same value" );
+	crossCheckModeInterface->AddNumber( CrossCheckComplementary, "Complementary", "The redundant line sends the complement of the value (maximum value minus the value)" );
+	crossCheckModeInterface->SetNumber( crossCheckMode );
+
+	mCrossCheckChannelInterface.reset( new AnalyzerSettingInterfaceChannel() );
+	mCrossCheckChannelInterface->SetTitleAndTooltip( "Cross-check line", "The redundant SENT line, decoded with the same settings" );
+	mCrossCheckChannelInterface->SetChannel( mCrossCheckChannel );
+	mCrossCheckChannelInterface->SetSelectionOfNoneIsAllowed( true );
+
+	crossCheckToleranceInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	crossCheckToleranceInterface->SetTitleAndTooltip( "Cross-check tolerance", "Specify the largest allowed difference between the values of both lines" );
+	crossCheckToleranceInterface->SetMax( 0xFFFFFF );
+	crossCheckToleranceInterface->SetMin( 0 );
+	crossCheckToleranceInterface->SetInteger( crossCheckTolerance );
+
+	crossCheckWindowInterface.reset( new AnalyzerSettingInterfaceInteger() );
+	crossCheckWindowInterface->SetTitleAndTooltip( "Cross-check window (ticks)", "Specify the largest allowed time difference between the start of the messages of both lines" );
+	crossCheckWindowInterface->SetMax( 10000 );
+	crossCheckWindowInterface->SetMin( 1 );
+	crossCheckWindowInterface->SetInteger( crossCheckWindowTicks );
+
+	simulationScenarioInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	simulationScenarioInterface->SetTitleAndTooltip( "Simulation data", "Specify the SENT signal generated by the simulation" );
+	simulationScenarioInterface->AddNumber( SimulationFixedFrames, "Fixed frames", "Two fixed frames, the second one with a pause pulse as long as a sync pulse" );
+	simulationScenarioInterface->AddNumber( SimulationCounter, "Rolling counter", "Frames with a valid CRC for any number of data nibbles, with a rolling counter in the first two fast channel nibbles" );
+	simulationScenarioInterface->AddNumber( SimulationDrift, "Drifting clock", "Rolling counter frames with a tick time that slowly drifts by up to 10%" );
+	simulationScenarioInterface->AddNumber( SimulationNoise, "Noisy", "Rolling counter frames with edge jitter, and occasional glitches and missed edges" );
+	simulationScenarioInterface->SetNumber( simulationScenario );
+
 	AddInterface( mInputChannelInterface.get() );
 	AddInterface( tickTimeInterface.get() );
 	AddInterface( pausePulseInterface.get() );
 	AddInterface( dataNibblesInterface.get() );
 	AddInterface( legacyCRCInterface.get() );
+	AddInterface( resyncInterface.get() );
+	AddInterface( counterNibbleInterface.get() );
+	AddInterface( counterNibblesInterface.get() );
+	AddInterface( periodToleranceInterface.get() );
+	AddInterface( errorsOnlyInterface.get() );
+	AddInterface( errorContextInterface.get() );
+	AddInterface( crossCheckModeInterface.get() );
+	AddInterface( mCrossCheckChannelInterface.get() );
+	AddInterface( crossCheckToleranceInterface.get() );
+	AddInterface( crossCheckWindowInterface.get() );
+	AddInterface( simulationScenarioInterface.get() );
 
 	AddExportOption( 0, "Export as text/csv file" );
 	AddExportExtension( 0, "text", "txt" );
 	AddExportExtension( 0, "csv", "csv" );
 
+	AddExportOption( 1, "Export continuity report" );
+	AddExportExtension( 1, "text", "txt" );
+	AddExportExtension( 1, "csv", "csv" );
+
+	AddExportOption( 2, "Export value overview" );
+	AddExportExtension( 2, "csv", "csv" );
+
 	ClearChannels();
 	AddChannel( mInputChannel, "Serial", false );
+	AddChannel( mCrossCheckChannel, "SENT cross-check", false );
 }
 
 SENTAnalyzerSettings::~SENTAnalyzerSettings()
@@ -53,14 +147,39 @@ SENTAnalyzerSettings::~SENTAnalyzerSettings()
 
 bool SENTAnalyzerSettings::SetSettingsFromInterfaces()
 {
+	if( (counterNibbleInterface->GetInteger() != 0) &&
+		(counterNibbleInterface->GetInteger() + counterNibblesInterface->GetInteger() - 1 > dataNibblesInterface->GetInteger() + 1) )
+	{
+		SetErrorText( "The rolling counter does not fit in the status and fast channel nibbles" );
+		return false;
+	}
+	if( ( crossCheckModeInterface->GetNumber() != CrossCheckOff ) &&
+		( ( mCrossCheckChannelInterface->GetChannel() == UNDEFINED_CHANNEL ) || ( mCrossCheckChannelInterface->GetChannel() == mInputChannelInterface->GetChannel() ) ) )
+	{
+		SetErrorText( "The cross-check needs a second SENT line" );
+		return false;
+	}
+
 	mInputChannel = mInputChannelInterface->GetChannel();
 	tick_time_half_us = tickTimeInterface->GetInteger();
 	pausePulseEnabled = pausePulseInterface->GetValue();
 	numberOfDataNibbles = dataNibblesInterface->GetInteger();
 	legacyCRC = legacyCRCInterface->GetValue();
+	resyncEnabled = resyncInterface->GetValue();
+	counterNibble = counterNibbleInterface->GetInteger();
+	counterNibbles = counterNibblesInterface->GetInteger();
+	periodTolerancePercent = periodToleranceInterface->GetInteger();
+	errorsOnly = errorsOnlyInterface->GetValue();
+	errorContextPackets = errorContextInterface->GetInteger();
+	crossCheckMode = crossCheckModeInterface->GetNumber();
+	mCrossCheckChannel = mCrossCheckChannelInterface->GetChannel();
+	crossCheckTolerance = crossCheckToleranceInterface->GetInteger();
+	crossCheckWindowTicks = crossCheckWindowInterface->GetInteger();
+	simulationScenario = simulationScenarioInterface->GetNumber();
 
 	ClearChannels();
 	AddChannel( mInputChannel, "SENT (SAE J2716)", true );
+	AddChannel( mCrossCheckChannel, "SENT cross-check", crossCheckMode != CrossCheckOff );
 
 	return true;
 }
@@ -72,6 +191,17 @@ void SENTAnalyzerSettings::UpdateInterfacesFromSettings()
 	pausePulseInterface->SetValue(pausePulseEnabled);
 	dataNibblesInterface->SetInteger(numberOfDataNibbles);
 	legacyCRCInterface->SetValue(legacyCRC);
+	resyncInterface->SetValue(resyncEnabled);
+	counterNibbleInterface->SetInteger(counterNibble);
+	counterNibblesInterface->SetInteger(counterNibbles);
+	periodToleranceInterface->SetInteger(periodTolerancePercent);
+	errorsOnlyInterface->SetValue(errorsOnly);
+	errorContextInterface->SetInteger(errorContextPackets);
+	crossCheckModeInterface->SetNumber(crossCheckMode);
+	mCrossCheckChannelInterface->SetChannel(mCrossCheckChannel);
+	crossCheckToleranceInterface->SetInteger(crossCheckTolerance);
+	crossCheckWindowInterface->SetInteger(crossCheckWindowTicks);
+	simulationScenarioInterface->SetNumber(simulationScenario);
 }
 
 void SENTAnalyzerSettings::LoadSettings( const char* settings )
@@ -84,9 +214,38 @@ void SENTAnalyzerSettings::LoadSettings( const char* settings )
 	text_archive >> pausePulseEnabled;
 	text_archive >> numberOfDataNibbles;
 	text_archive >> legacyCRC;
+	/* Settings saved by older versions end here */
+	if( !( text_archive >> resyncEnabled ) )
+	{
+		resyncEnabled = false;
+	}
+	if( !( text_archive >> counterNibble ) || !( text_archive >> counterNibbles ) || !( text_archive >> periodTolerancePercent ) )
+	{
+		counterNibble = 0;
+		counterNibbles = 1;
+		periodTolerancePercent = 0;
+	}
+	if( !( text_archive >> errorsOnly ) || !( text_archive >> errorContextPackets ) )
+	{
+		errorsOnly = false;
+		errorContextPackets = 2;
+	}
+	if( !( text_archive >> crossCheckMode ) || !( text_archive >> mCrossCheckChannel ) ||
+		!( text_archive >> crossCheckTolerance ) || !( text_archive >> crossCheckWindowTicks ) )
+	{
+		crossCheckMode = CrossCheckOff;
+		mCrossCheckChannel = UNDEFINED_CHANNEL;
+		crossCheckTolerance = 0;
+		crossCheckWindowTicks = 100;
+	}
+	if( !( text_archive >> simulationScenario ) )
+	{
+		simulationScenario = SimulationFixedFrames;
+	}
 
 	ClearChannels();
 	AddChannel( mInputChannel, "SENT (SAE J2716)", true );
+	AddChannel( mCrossCheckChannel, "SENT cross-check", crossCheckMode != CrossCheckOff );
 
 	UpdateInterfacesFromSettings();
 }
@@ -100,6 +259,17 @@ const char* SENTAnalyzerSettings::SaveSettings()
 	text_archive << pausePulseEnabled;
 	text_archive << numberOfDataNibbles;
 	text_archive << legacyCRC;
+	text_archive << resyncEnabled;
+	text_archive << counterNibble;
+	text_archive << counterNibbles;
+	text_archive << periodTolerancePercent;
+	text_archive << errorsOnly;
+	text_archive << errorContextPackets;
+	text_archive << crossCheckMode;
+	text_archive << mCrossCheckChannel;
+	text_archive << crossCheckTolerance;
+	text_archive << crossCheckWindowTicks;
+	text_archive << simulationScenario;
 
 	return SetReturnString( text_archive.GetString() );
 }
@@ -4,6 +4,9 @@
 #include <AnalyzerSettings.h>
 #include <AnalyzerTypes.h>
 
+enum SENTCrossCheckMode { CrossCheckOff, CrossCheckEqual, CrossCheckComplementary };
+enum SENTSimulationScenario { SimulationFixedFrames, SimulationCounter, SimulationDrift, SimulationNoise };
+
 class SENTAnalyzerSettings : public AnalyzerSettings
 {
 public:
@@ -21,6 +24,17 @@ public:
 	bool pausePulseEnabled;
 	U32 numberOfDataNibbles;
 	bool legacyCRC;
+	bool resyncEnabled;
+	U32 counterNibble;
+	U32 counterNibbles;
+	U32 periodTolerancePercent;
+	bool errorsOnly;
+	U32 errorContextPackets;
+	U32 crossCheckMode;
+	Channel mCrossCheckChannel;
+	U32 crossCheckTolerance;
+	U32 crossCheckWindowTicks;
+	U32 simulationScenario;
 
 protected:
 	std::auto_ptr< AnalyzerSettingInterfaceChannel >	mInputChannelInterface;
@@ -28,6 +42,17 @@ protected:
 	std::auto_ptr< AnalyzerSettingInterfaceBool >		pausePulseInterface;
 	std::auto_ptr< AnalyzerSettingInterfaceInteger >	dataNibblesInterface;
 	std::auto_ptr< AnalyzerSettingInterfaceBool >		legacyCRCInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceBool >		resyncInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	counterNibbleInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	counterNibblesInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	periodToleranceInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceBool >		errorsOnlyInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	errorContextInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList >	crossCheckModeInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceChannel >	mCrossCheckChannelInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	crossCheckToleranceInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceInteger >	crossCheckWindowInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList >	simulationScenarioInterface;
 };
 
 #endif //SENT_ANALYZER_SETTINGS
@@ -0,0 +1,563 @@
+#include "SENTDecoder.h"
+#include <math.h>
+
+#define STATUS_NIBBLE_NUMBER 	(1)
+/* Number of pulses a message may exceed its nominal length by before it is given up on (resynchronisation)
+   or before further pulses are only counted */
+#define RESYNC_LOOKAHEAD 		(2)
+/* Successive sync pulses may differ by at most 1/64 of their length (SAE J2716) */
+#define SYNC_TOLERANCE_DIVISOR 	(64)
+
+SENTDecoder::SENTDecoder()
+{
+	Initialize( 1.0, SENT_MAX_DATA_NIBBLES, true, false, false );
+}
+
+SENTDecoder::~SENTDecoder()
+{
+}
+
+/** Resets the decoder
+ *
+ *  @param [in] 	samples_per_tick 		The theoretical number of samples per tick
+ *  @param [in] 	number_of_data_nibbles 	The number of fast channel data nibbles
+ *  @param [in] 	pause_pulse_enabled 	Whether the messages end with a pause pulse
+ *  @param [in] 	legacy_crc 				Whether the legacy CRC algorithm is used
+ *  @param [in] 	resync_enabled 			Whether corrupted messages are realigned against the CRC
+ */
+void SENTDecoder::Initialize( double samples_per_tick, U32 number_of_data_nibbles, bool pause_pulse_enabled, bool legacy_crc, bool resync_enabled )
+{
+	mTheoreticalSamplesPerTick = samples_per_tick;
+	mCorrectedSamplesPerTick = samples_per_tick;
+	mNumberOfDataNibbles = number_of_data_nibbles;
+	mPausePulseEnabled = pause_pulse_enabled;
+	mLegacyCRC = legacy_crc;
+	mResyncEnabled = resync_enabled;
+	mCrcNibbleNumber = STATUS_NIBBLE_NUMBER + number_of_data_nibbles + 1;
+	mPausePulseNumber = mCrcNibbleNumber + 1;
+	mNumberOfPulses = pause_pulse_enabled ? mPausePulseNumber + 1 : mCrcNibbleNumber + 1;
+
+	mHasEdge = false;
+	mPreviousEdge = 0;
+	mValidSyncSamples = 0;
+	mNibbleCounter = 0;
+	mResynchronised = false;
+	mSkippedPulses = 0;
+	mPulses.clear();
+	mPulses.reserve( mNumberOfPulses + RESYNC_LOOKAHEAD + 1 );
+	mMessagePulses.clear();
+	mMessagePulses.reserve( mNumberOfPulses + RESYNC_LOOKAHEAD + 1 );
+}
+
+/** Returns the pulses of the last completed message, starting with its sync pulse
+ *
+ *  For a message that is too long to be valid, only the first and the last pulses are kept.
+ *  SENTMessage::number_of_pulses holds the number of pulses that were received.
+ */
+const std::vector<SENTPulse>& SENTDecoder::GetPulses() const
+{
+	return mMessagePulses;
+}
+
+/** Returns the tick time measured on the last sync pulse, in samples */
+double SENTDecoder::GetSamplesPerTick() const
+{
+	return mCorrectedSamplesPerTick;
+}
+
+/** Function for calculation the SENT CRC4
+ *
+ *  @param [in] 	nibbles 			The data nibbles, without status nibble
+ *  @param [in] 	number_of_nibbles 	The number of data nibbles
+ *  @param [in] 	legacy_crc 			Whether the legacy CRC algorithm is used
+ *  @returns 	U8	the calculated CRC4
+ */
+U8 SENTDecoder::CalculateCRC( const U8* nibbles, U32 number_of_nibbles, bool legacy_crc )
+{
+	static const U8 crc4_table [16] = {0, 13, 7, 10, 14, 3, 9, 4, 1, 12, 6, 11, 15, 2, 8, 5};
+	U8 CheckSum16 = 5;
+
+	/* The mask keeps the table lookup in range, should a nibble be out of range */
+	for( U32 i = 0; i < number_of_nibbles; i++ )
+	{
+		CheckSum16 = ( nibbles[i] ^ crc4_table[CheckSum16] ) & 0x0F;
+	}
+	if( !legacy_crc )
+	{
+		CheckSum16 = 0 ^ crc4_table[CheckSum16];
+	}
+	return CheckSum16;
+}
+
+/** Function for calculation the SENT CRC4 on the given pulses
+ *
+ *  @param [in] 	pulses 	The pulses of a message, starting with the sync pulse. Anything after the CRC nibble is ignored.
+ *  @returns 	U8	the calculated CRC4 on the data of the pulses.
+ */
+U8 SENTDecoder::calculateCRC( const std::vector<SENTPulse>& pulses )
+{
+	U8 nibbles[SENT_MAX_DATA_NIBBLES];
+
+	/* We skip the sync and status nibbles, and stop at the CRC nibble to omit the CRC and pause nibbles */
+	for( U16 i = STATUS_NIBBLE_NUMBER + 1; i < mCrcNibbleNumber; i++ )
+	{
+		nibbles[i - STATUS_NIBBLE_NUMBER - 1] = pulses[i].data;
+	}
+	return CalculateCRC( nibbles, mNumberOfDataNibbles, mLegacyCRC );
+}
+
+/** Returns the number of samples between the falling edges delimiting a pulse */
+static U64 pulseSamples( const SENTPulse& pulse )
+{
+	return pulse.end_sample - pulse.start_sample;
+}
+
+/** Function for determining if the pulse is a sync pulse or not
+ *
+ *	First, the function checks if the pulse is 56 ticks wide.
+ *	This narrows the choice down to 2 options: sync pulse and pause pulse
+ *	(the other pulses are between 12 and 27 ticks wide)
+ *
+ *	Then, in order to determine whether it's a pause pulse or not, we check
+ *	whether we were expecting a pause pulse to begin with. If so, we take the
+ *	naive approach and assume it's a pause pulse. If not, we say it's a valid
+ *	sync pulse.
+ *
+ *	When resynchronisation is enabled, the nibble counter is not trusted. Instead,
+ *	the choice between sync and pause is made by checking which of both alignments
+ *	results in a valid frame (see resyncPausePulse). A sync sized pulse right after
+ *	the sync pulse is not a sync pulse when only the sync pulse matches the sync pulse
+ *	of the last valid message: it is two nibbles merged by a missed edge.
+ *
+ *  @param [in] 	number_of_ticks 	The width of the pulse in theoretical ticks
+ *  @param [in] 	number_of_samples 	The width of the pulse in samples
+ *  @retval 	true	The pulse is a sync pulse
+ *  @retval     false 	The pulse is not a sync pulse
+ */
+bool SENTDecoder::isSyncPulse( U16 number_of_ticks, U32 number_of_samples )
+{
+	/* Sync pulse should be 56 ticks. Given a 20% margin, it should fall in range [45:67] */
+	if( number_of_ticks < 45 || number_of_ticks > 67 )
+	{
+		return false;
+	}
+	if( mPausePulseEnabled && mResyncEnabled )
+	{
+		if( mPulses.size() == 1 && mPulses.front().type == SyncPulse && mValidSyncSamples > 0 )
+		{
+			U64 sync_samples = pulseSamples( mPulses.front() );
+			U64 tolerance = mValidSyncSamples / SYNC_TOLERANCE_DIVISOR;
+			U64 sync_deviation = ( sync_samples > mValidSyncSamples ) ? sync_samples - mValidSyncSamples : mValidSyncSamples - sync_samples;
+			U64 pulse_deviation = ( number_of_samples > mValidSyncSamples ) ? number_of_samples - mValidSyncSamples : mValidSyncSamples - number_of_samples;
+			if( sync_deviation <= tolerance && pulse_deviation > tolerance )
+			{
+				return false;
+			}
+		}
+		return !resyncPausePulse();
+	}
+	return !( mPausePulseEnabled && mNibbleCounter == mPausePulseNumber );
+}
+
+/** Function for classifying the pulses of a frame purely on their position
+ *
+ *  The nibble counter is not used: the first pulse is the sync pulse, the next ones
+ *  the status, FC and CRC nibbles. The nibble values are recalculated from the pulse widths.
+ *
+ *  @param [in,out] 	pulses 				Sync pulse followed by the data carrying pulses, without pause pulse
+ *  @param [in] 		samples_per_tick 	The tick time to use for the conversion of pulse widths to ticks
+ *  @retval 	true	All nibbles are within range and the CRC matches
+ *  @retval     false 	The pulses do not form a valid frame
+ */
+bool SENTDecoder::classifyFrame( std::vector<SENTPulse>& pulses, double samples_per_tick )
+{
+	if( pulses.size() != (U32)( mCrcNibbleNumber + 1 ) )
+	{
+		return false;
+	}
+
+	pulses[0].type = SyncPulse;
+	pulses[0].data = 56;
+	for( U16 i = STATUS_NIBBLE_NUMBER; i <= mCrcNibbleNumber; i++ )
+	{
+		U16 number_of_ticks = round( pulseSamples( pulses[i] ) / samples_per_tick );
+		if( number_of_ticks < 12 || number_of_ticks > 27 )
+		{
+			return false;
+		}
+		pulses[i].data = number_of_ticks - 12;
+		if( i == STATUS_NIBBLE_NUMBER )
+		{
+			pulses[i].type = StatusNibble;
+		}
+		else if( i == mCrcNibbleNumber )
+		{
+			pulses[i].type = CRCNibble;
+		}
+		else
+		{
+			pulses[i].type = FCNibble;
+		}
+	}
+	return pulses[mCrcNibbleNumber].data == calculateCRC( pulses );
+}
+
+/** Speculative resynchronisation of a frame
+ *
+ *  Tries the alignments of the pulses that a single corrupted edge can explain, and checks each of them against the CRC:
+ *
+ *  - The pulses as they are, classified on their position only
+ *  - One pulse too many: a glitch split a nibble in two. Every pair of adjacent pulses is merged.
+ *  - One pulse too few: an edge was missed and two nibbles were merged. Every pulse is split in every possible way.
+ *
+ *  Only a single candidate of the whole set is allowed to validate, as the CRC4 can not tell apart
+ *  several candidates. The amount of candidates is bounded by the frame length, so this takes constant memory.
+ *
+ *  @param [in,out] 	pulses 		Sync pulse followed by the data carrying pulses, without pause pulse.
+ *  								Replaced by the realigned frame on success.
+ *  @param [out] 		realigned 	Whether the realigned frame differs from the pulses as decoded
+ *  @retval 	true	A single alignment validates
+ *  @retval     false 	No or multiple alignments validate, pulses is left untouched
+ */
+bool SENTDecoder::realignFrame( std::vector<SENTPulse>& pulses, bool& realigned )
+{
+	U32 expected_size = mCrcNibbleNumber + 1;
+	if( pulses.size() < 2 || pulses.size() > expected_size + 1 || pulses.front().type != SyncPulse )
+	{
+		return false;
+	}
+
+	double samples_per_tick = pulseSamples( pulses.front() ) / 56.0;
+	std::vector<SENTPulse> candidate;
+	std::vector<SENTPulse> match;
+	U32 number_of_matches = 0;
+
+	if( pulses.size() == expected_size )
+	{
+		candidate = pulses;
+		if( classifyFrame( candidate, samples_per_tick ) )
+		{
+			match = candidate;
+			number_of_matches++;
+		}
+	}
+	else if( pulses.size() == expected_size + 1 )
+	{
+		for( U32 i = STATUS_NIBBLE_NUMBER; i + 1 < pulses.size(); i++ )
+		{
+			candidate.assign( pulses.begin(), pulses.begin() + i + 1 );
+			candidate.back().end_sample = pulses[i + 1].end_sample;
+			candidate.insert( candidate.end(), pulses.begin() + i + 2, pulses.end() );
+			if( classifyFrame( candidate, samples_per_tick ) )
+			{
+				match = candidate;
+				number_of_matches++;
+			}
+		}
+	}
+	else if( pulses.size() + 1 == expected_size )
+	{
+		for( U32 i = STATUS_NIBBLE_NUMBER; i < pulses.size(); i++ )
+		{
+			for( U16 first_ticks = 12; first_ticks <= 27; first_ticks++ )
+			{
+				U64 first_samples = round( first_ticks * samples_per_tick );
+				if( first_samples >= pulseSamples( pulses[i] ) )
+				{
+					break;
+				}
+				candidate.assign( pulses.begin(), pulses.begin() + i + 1 );
+				candidate.back().end_sample = pulses[i].start_sample + first_samples;
+				candidate.push_back( pulses[i] );
+				candidate.back().start_sample = pulses[i].start_sample + first_samples;
+				candidate.insert( candidate.end(), pulses.begin() + i + 1, pulses.end() );
+				if( classifyFrame( candidate, samples_per_tick ) )
+				{
+					match = candidate;
+					number_of_matches++;
+				}
+			}
+		}
+	}
+
+	if( number_of_matches != 1 )
+	{
+		return false;
+	}
+
+	/* The alignment may differ from the one seen while decoding */
+	realigned = ( match.size() != pulses.size() );
+	for( U32 i = 0; !realigned && i < match.size(); i++ )
+	{
+		realigned = ( match[i].type != pulses[i].type ) || ( match[i].data != pulses[i].data );
+	}
+	pulses.swap( match );
+	return true;
+}
+
+/** Function for resynchronising the message collected since the last sync pulse, if it is not valid
+ *
+ *  The last pulse is taken to be the pause pulse (if enabled) and is left out of the realignment.
+ */
+void SENTDecoder::resyncFrame()
+{
+	bool valid = ( mPulses.size() == mNumberOfPulses );
+	for( std::vector<SENTPulse>::iterator it = mPulses.begin(); valid && it != mPulses.end(); it++ )
+	{
+		valid = ( it->type != Unknown );
+	}
+	if( valid || mPulses.empty() )
+	{
+		return;
+	}
+
+	std::vector<SENTPulse> pulses( mPulses );
+	bool realigned = false;
+	if( mPausePulseEnabled )
+	{
+		pulses.pop_back();
+	}
+	if( realignFrame( pulses, realigned ) )
+	{
+		if( mPausePulseEnabled )
+		{
+			SENTPulse pause_pulse = mPulses.back();
+			pause_pulse.type = PausePulse;
+			pause_pulse.data = round( pulseSamples( pause_pulse ) / ( pulseSamples( pulses.front() ) / 56.0 ) );
+			pulses.push_back( pause_pulse );
+		}
+		mPulses.swap( pulses );
+		mResynchronised = mResynchronised || realigned;
+	}
+}
+
+/** Function for deciding whether a sync sized pulse is a pause pulse, when resynchronisation is enabled
+ *
+ *  The alignment that validates wins. As a wrongly detected pause pulse costs the next message as well,
+ *  the sync pulse interpretation is tried first:
+ *
+ *  - The pulses so far form a valid frame including its pause pulse: this is a sync pulse
+ *  - The pulses so far form a valid frame without pause pulse: this is the pause pulse
+ *  - Same two checks, but allowing the frame to be realigned
+ *  - Otherwise, this is a sync pulse
+ *
+ *  When the pulse is taken as the pause pulse, the pulses collected so far are replaced by their realigned version
+ *  and the nibble counter is set to the pause pulse position.
+ *
+ *  @retval 	true	The pulse is a pause pulse
+ *  @retval     false 	The pulse is a sync pulse
+ */
+bool SENTDecoder::resyncPausePulse()
+{
+	if( mPulses.empty() || mPulses.front().type != SyncPulse )
+	{
+		return false;
+	}
+
+	double samples_per_tick = pulseSamples( mPulses.front() ) / 56.0;
+	bool realigned = false;
+	std::vector<SENTPulse> pulses( mPulses.begin(), mPulses.end() - 1 );
+	if( classifyFrame( pulses, samples_per_tick ) )
+	{
+		return false;
+	}
+	pulses = mPulses;
+	if( classifyFrame( pulses, samples_per_tick ) )
+	{
+		mPulses.swap( pulses );
+		mNibbleCounter = mPausePulseNumber;
+		return true;
+	}
+
+	pulses.assign( mPulses.begin(), mPulses.end() - 1 );
+	if( realignFrame( pulses, realigned ) )
+	{
+		return false;
+	}
+	pulses = mPulses;
+	if( realignFrame( pulses, realigned ) )
+	{
+		mPulses.swap( pulses );
+		mResynchronised = mResynchronised || realigned;
+		mNibbleCounter = mPausePulseNumber;
+		return true;
+	}
+	return false;
+}
+
+/** Completes the message collected since the last sync pulse
+ *
+ *  The message is valid when it has the expected number of pulses, all of them of the expected type, and its CRC matches.
+ *
+ *  @param [out] 	message 	The completed message
+ *  @param [in] 	resync 		Whether resynchronisation (if enabled) may be tried on the message
+ *  @retval 	true	A message was completed
+ *  @retval     false 	There was no message, i.e. this is the first sync pulse
+ */
+bool SENTDecoder::finishMessage( SENTMessage& message, bool resync )
+{
+	if( mPulses.empty() )
+	{
+		return false;
+	}
+
+	if( resync && mResyncEnabled )
+	{
+		resyncFrame();
+
+		/* A lone sync sized pulse right before a sync pulse is the pause pulse of a message that could not be recovered,
+		   which was already reported */
+		if( mPausePulseEnabled && ( mPulses.size() == 1 ) && ( mPulses.front().type == SyncPulse ) )
+		{
+			mPulses.clear();
+			mResynchronised = false;
+			return false;
+		}
+	}
+
+	message = SENTMessage();
+	message.start_sample = mPulses.front().start_sample;
+	message.end_sample = mPulses.back().end_sample;
+	U32 number_of_pulses = mPulses.size() - 1 + mSkippedPulses;
+	message.number_of_pulses = ( number_of_pulses > 0xFF ) ? 0xFF : number_of_pulses;
+	message.resynchronised = mResynchronised;
+
+	bool valid = ( mPulses.size() == mNumberOfPulses ) && ( mSkippedPulses == 0 ) && ( mPulses.front().type == SyncPulse );
+	U32 data_nibbles = 0;
+	for( std::vector<SENTPulse>::iterator it = mPulses.begin(); it != mPulses.end(); it++ )
+	{
+		if( it->type == StatusNibble )
+		{
+			message.status = it->data;
+		}
+		else if( it->type == FCNibble && data_nibbles < SENT_MAX_DATA_NIBBLES )
+		{
+			message.data[data_nibbles++] = it->data;
+		}
+		else if( it->type == CRCNibble )
+		{
+			message.crc = it->data;
+		}
+		else if( it->type == Unknown )
+		{
+			valid = false;
+		}
+	}
+
+	if( !valid )
+	{
+		message.error = MessageNibbleNumberError;
+	}
+	else if( message.crc != CalculateCRC( message.data, mNumberOfDataNibbles, mLegacyCRC ) )
+	{
+		message.error = MessageCrcError;
+	}
+	else
+	{
+		message.error = MessageValid;
+		mValidSyncSamples = pulseSamples( mPulses.front() );
+	}
+
+	message.value = 0;
+	for( U32 i = 0; i < mNumberOfDataNibbles; i++ )
+	{
+		message.value = ( message.value << 4 ) | message.data[i];
+	}
+
+	mMessagePulses.swap( mPulses );
+	mPulses.clear();
+	mSkippedPulses = 0;
+	mResynchronised = false;
+	return true;
+}
+
+/** Feeds the next falling edge of the line to the decoder
+ *
+ *  @param [in] 	sample 		The sample number of the falling edge
+ *  @param [out] 	message 	The completed message, if any. Its pulses are available through GetPulses().
+ *  @retval 	true	A message was completed: the edge ended the sync pulse of the next message,
+ *  					or the message got too long to be recovered
+ *  @retval     false 	No message was completed
+ */
+bool SENTDecoder::AddFallingEdge( U64 sample, SENTMessage& message )
+{
+	if( !mHasEdge )
+	{
+		mHasEdge = true;
+		mPreviousEdge = sample;
+		return false;
+	}
+
+	SENTPulse pulse;
+	pulse.start_sample = mPreviousEdge;
+	pulse.end_sample = sample;
+	pulse.type = Unknown;
+	mPreviousEdge = sample;
+
+	U32 number_of_samples = pulseSamples( pulse );
+	U16 theoretical_number_of_ticks = round( number_of_samples / mTheoreticalSamplesPerTick );
+	U16 corrected_number_of_ticks = round( number_of_samples / mCorrectedSamplesPerTick );
+	bool completed = false;
+
+	/* A sync pulse closes the previous message and corrects the tick time */
+	if( isSyncPulse( theoretical_number_of_ticks, number_of_samples ) )
+	{
+		mCorrectedSamplesPerTick = round( number_of_samples / 56.0 );
+		completed = finishMessage( message, true );
+		pulse.type = SyncPulse;
+		corrected_number_of_ticks = 56;
+		mNibbleCounter = 0;
+	}
+	/* The pause pulse can take a larger range of sizes than any of the other pulse types,
+	   so no sense in checking for the amount of ticks */
+	else if( mNibbleCounter == mPausePulseNumber )
+	{
+		pulse.type = PausePulse;
+	}
+	/* Data carrying nibbles are 12 to 27 ticks, the actual data is the number of ticks minus 12 */
+	else if( corrected_number_of_ticks > 11 && corrected_number_of_ticks < 28 )
+	{
+		if( mNibbleCounter == STATUS_NIBBLE_NUMBER )
+		{
+			pulse.type = StatusNibble;
+			corrected_number_of_ticks -= 12;
+		}
+		else if( mNibbleCounter > STATUS_NIBBLE_NUMBER && mNibbleCounter < mCrcNibbleNumber )
+		{
+			pulse.type = FCNibble;
+			corrected_number_of_ticks -= 12;
+		}
+		else if( mNibbleCounter == mCrcNibbleNumber )
+		{
+			pulse.type = CRCNibble;
+			corrected_number_of_ticks -= 12;
+		}
+	}
+	/* No valid nibble was detected */
+	else
+	{
+		mNibbleCounter = 0;
+	}
+
+	mNibbleCounter++;
+	pulse.data = corrected_number_of_ticks;
+
+	/* Bound the pulses kept for a message, a message this long can not be recovered anymore.
+	   With resynchronisation, it is given up on right away, so the realignment can start over on the next pulses.
+	   Without, the whole stretch up to the next sync pulse is one error: only its last pulse is kept, the others are counted */
+	if( !mResyncEnabled && mPulses.size() > (U32)( mNumberOfPulses + RESYNC_LOOKAHEAD ) )
+	{
+		mPulses.back() = pulse;
+		mSkippedPulses++;
+	}
+	else
+	{
+		mPulses.push_back( pulse );
+	}
+	if( mResyncEnabled && mPulses.size() > (U32)( mNumberOfPulses + RESYNC_LOOKAHEAD ) )
+	{
+		completed = finishMessage( message, false );
+	}
+
+	return completed;
+}
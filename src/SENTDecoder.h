@@ -0,0 +1,88 @@
+#ifndef SENT_DECODER
+#define SENT_DECODER
+
+#include <LogicPublicTypes.h>
+#include <vector>
+
+#define SENT_MAX_DATA_NIBBLES 	(6)
+
+enum SENTNibbleType { SyncPulse, StatusNibble, FCNibble, CRCNibble, PausePulse, Unknown, Error};
+enum SENTMessageError { MessageValid, MessageNibbleNumberError, MessageCrcError };
+
+/* A single pulse, between two falling edges */
+struct SENTPulse
+{
+	U64 start_sample;						/* Falling edge at the start of the pulse */
+	U64 end_sample;							/* Falling edge at the end of the pulse */
+	U16 data;								/* Nibble value for status, FC and CRC nibbles, number of ticks otherwise */
+	U8 type;								/* SENTNibbleType */
+};
+
+/* A SENT message, as decoded by SENTDecoder */
+struct SENTMessage
+{
+	U64 start_sample;						/* Falling edge at the start of the sync pulse */
+	U64 end_sample;							/* Falling edge at the end of the last pulse of the message */
+	U32 value;								/* Data nibbles concatenated, most significant nibble first */
+	U8 status;
+	U8 data[SENT_MAX_DATA_NIBBLES];
+	U8 crc;
+	U8 number_of_pulses;					/* Pulses received after the sync pulse, including the pause pulse. Saturates at 255 */
+	U8 error;								/* SENTMessageError */
+	U8 resynchronised;						/* The message only validated after realigning its pulses */
+};
+
+/** Streaming decoder of a single SENT line
+ *
+ *  Pulses are measured between falling edges, classified on their width and the nibble counter,
+ *  and the tick time is corrected on every sync pulse. A message is completed when the sync
+ *  pulse of the next message is detected. When resynchronisation is enabled, messages that are
+ *  corrupted by a glitch or a missed edge are realigned against the CRC before they are completed.
+ *
+ *  This is the only decoding path: the analyzer decodes both the main and the cross-check line with it,
+ *  and the Python module uses it as well. It doesn't depend on the analyzer SDK library, so it can decode
+ *  any list of falling edges.
+ */
+class SENTDecoder
+{
+public:
+	SENTDecoder();
+	~SENTDecoder();
+
+	void Initialize( double samples_per_tick, U32 number_of_data_nibbles, bool pause_pulse_enabled, bool legacy_crc, bool resync_enabled );
+	bool AddFallingEdge( U64 sample, SENTMessage& message );
+	const std::vector<SENTPulse>& GetPulses() const;
+	double GetSamplesPerTick() const;
+
+	static U8 CalculateCRC( const U8* nibbles, U32 number_of_nibbles, bool legacy_crc );
+
+protected:
+	bool isSyncPulse( U16 number_of_ticks, U32 number_of_samples );
+	bool finishMessage( SENTMessage& message, bool resync );
+	U8 calculateCRC( const std::vector<SENTPulse>& pulses );
+	bool classifyFrame( std::vector<SENTPulse>& pulses, double samples_per_tick );
+	bool realignFrame( std::vector<SENTPulse>& pulses, bool& realigned );
+	void resyncFrame();
+	bool resyncPausePulse();
+
+	double mTheoreticalSamplesPerTick;
+	double mCorrectedSamplesPerTick;
+	U32 mNumberOfDataNibbles;
+	bool mPausePulseEnabled;
+	bool mLegacyCRC;
+	bool mResyncEnabled;
+	U16 mCrcNibbleNumber;
+	U16 mPausePulseNumber;
+	U16 mNumberOfPulses;
+
+	bool mHasEdge;
+	U64 mPreviousEdge;
+	U64 mValidSyncSamples;					/* Length of the sync pulse of the last valid message, 0 if none */
+	U16 mNibbleCounter;
+	bool mResynchronised;
+	U32 mSkippedPulses;						/* Pulses of the current message that were counted but not kept */
+	std::vector<SENTPulse> mPulses;
+	std::vector<SENTPulse> mMessagePulses;
+};
+
+#endif //SENT_DECODER
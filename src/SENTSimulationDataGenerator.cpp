@@ -1,11 +1,27 @@
 #include "SENTSimulationDataGenerator.h"
 #include "SENTAnalyzerSettings.h"
 
+#include "SENTDecoder.h"
+
 #include <AnalyzerHelpers.h>
+#include <math.h>
 
 int fc_data [6] = {27, 17, 22, 14, 20, 12};
 
+/* Number of frames of one period of the tick time drift */
+#define DRIFT_PERIOD_FRAMES 2000
+/* Largest tick time deviation of the drifting clock, well within the sync pulse detection range */
+#define DRIFT_MAX 0.1
+/* Largest edge jitter of the noisy signal in ticks. Pulse widths stay within half a tick */
+#define JITTER_MAX_TICKS 0.2
+/* Every pulse of a noisy frame has a chance of one in ten times this number to be hit by a glitch,
+   and the same chance to have a missed edge. That is roughly one of each per this many frames */
+#define NOISE_FRAMES 100
+
 SENTSimulationDataGenerator::SENTSimulationDataGenerator()
+:	mNextEdge(0),
+	mFrameCounter(0),
+	mRandomState(1)
 {
 }
 
@@ -21,6 +37,10 @@ void SENTSimulationDataGenerator::Initialize( U32 simulation_sample_rate, SENTAn
 	mSerialSimulationData.SetChannel( settings->mInputChannel );
 	mSerialSimulationData.SetSampleRate( simulation_sample_rate );
 	mSerialSimulationData.SetInitialBitState( BIT_HIGH );
+
+	mNextEdge = mSerialSimulationData.GetCurrentSampleNumber();
+	mFrameCounter = 0;
+	mRandomState = 1;
 }
 
 U32 SENTSimulationDataGenerator::GenerateSimulationData( U64 largest_sample_requested, U32 sample_rate, SimulationChannelDescriptor** simulation_channel )
@@ -36,20 +56,131 @@ U32 SENTSimulationDataGenerator::GenerateSimulationData( U64 largest_sample_requ
 	return 1;
 }
 
-void SENTSimulationDataGenerator::AddNibble(U16 number_of_ticks, U16 samples_per_tick)
+/** Pseudo random number in range [0:range[
+ *
+ *  A simple linear congruential generator, so that every simulation of the same settings gives the same signal
+ */
+U32 SENTSimulationDataGenerator::random(U32 range)
 {
-	U16 number_of_high_ticks = number_of_ticks - 5;
+	mRandomState = mRandomState * 1103515245 + 12345;
+	return (mRandomState >> 16) % range;
+}
+
+/** Function for adding a single pulse to the simulated signal
+ *
+ *  The pulse consists of a low time of 5 ticks, followed by a high time for the remaining ticks.
+ *  The position of the falling edge is kept as a fractional number of samples, so that tick times
+ *  of a non-integer number of samples do not accumulate rounding errors.
+ *  In the noisy scenario, jitter is added to the falling edge, and the pulse is occasionally split
+ *  by a glitch or merged with the previous one by leaving out its falling edge.
+ *
+ *  @param [in] 		number_of_ticks 	The total length of the pulse in ticks
+ *  @param [in] 		samples_per_tick 	The tick time in samples
+ */
+void SENTSimulationDataGenerator::AddNibble(U16 number_of_ticks, double samples_per_tick)
+{
+	bool noisy = (mSettings->simulationScenario == SimulationNoise);
+	double edge = mNextEdge;
+	mNextEdge += number_of_ticks * samples_per_tick;
+
+	/* Missed edge, the line stays high and this pulse merges with the previous one */
+	if(noisy && (random(NOISE_FRAMES * 10) == 0))
+	{
+		return;
+	}
+	if(noisy)
+	{
+		edge += (random(2001) / 1000.0 - 1.0) * JITTER_MAX_TICKS * samples_per_tick;
+	}
+
+	/* Jitter can not move the edge before the end of the previous pulse */
+	U64 falling_edge = mSerialSimulationData.GetCurrentSampleNumber();
+	if(edge > falling_edge)
+	{
+		falling_edge = round(edge);
+		mSerialSimulationData.Advance( falling_edge - mSerialSimulationData.GetCurrentSampleNumber() );
+	}
 	mSerialSimulationData.Transition();
-	mSerialSimulationData.Advance( samples_per_tick * 5);
+	mSerialSimulationData.Advance( round(edge + 5 * samples_per_tick) - falling_edge );
 	mSerialSimulationData.Transition();
-	mSerialSimulationData.Advance( samples_per_tick * number_of_high_ticks);
+
+	/* Glitch, a short low pulse in the middle of the high time splits this pulse in two */
+	if(noisy && (number_of_ticks > 10) && (random(NOISE_FRAMES * 10) == 0))
+	{
+		U64 glitch = round(edge + (5 + random(number_of_ticks - 7) + 1) * samples_per_tick);
+		mSerialSimulationData.Advance( glitch - mSerialSimulationData.GetCurrentSampleNumber() );
+		mSerialSimulationData.Transition();
+		mSerialSimulationData.Advance( 1 );
+		mSerialSimulationData.Transition();
+	}
+}
+
+/** Function for adding a frame with a valid CRC for any number of data nibbles
+ *
+ *  The first (up to two) fast channel nibbles contain a rolling counter, most significant nibble first,
+ *  the other fast channel nibbles a sawtooth. The status nibble is always 0.
+ *  With a pause pulse, the pause pulse fills the frame up to a constant message period.
+ *  In the drifting scenario, the tick time follows a triangle of DRIFT_PERIOD_FRAMES frames around its nominal value.
+ */
+void SENTSimulationDataGenerator::CreateCounterFrame()
+{
+	double samples_per_tick = mSimulationSampleRateHz * ((float)mSettings->tick_time_half_us / 2.0) / 1000000;
+	U8 data[SENT_MAX_DATA_NIBBLES];
+	U32 number_of_nibbles = mSettings->numberOfDataNibbles;
+	U32 frame_ticks = 0;
+
+	if(mSettings->simulationScenario == SimulationDrift)
+	{
+		double phase = (double)(mFrameCounter % DRIFT_PERIOD_FRAMES) / DRIFT_PERIOD_FRAMES;
+		samples_per_tick *= 1.0 + DRIFT_MAX * (4 * fabs(phase - 0.5) - 1);
+	}
+
+	for(U32 i = 0; i < number_of_nibbles; i++)
+	{
+		if(i < 2)
+		{
+			U32 counter_nibbles = (number_of_nibbles < 2) ? number_of_nibbles : 2;
+			data[i] = (mFrameCounter >> (4 * (counter_nibbles - 1 - i))) & 0x0F;
+		}
+		else
+		{
+			data[i] = ((mFrameCounter * 3) >> (4 * (number_of_nibbles - 1 - i))) & 0x0F;
+		}
+	}
+
+	/* Calibration pulse */
+	AddNibble(56, samples_per_tick);
+	/* Status nibble */
+	AddNibble(12, samples_per_tick);
+	frame_ticks += 56 + 12;
+	/* Fast channel nibbles */
+	for(U32 i = 0; i < number_of_nibbles; i++)
+	{
+		AddNibble(12 + data[i], samples_per_tick);
+		frame_ticks += 12 + data[i];
+	}
+	/* CRC */
+	U8 crc = SENTDecoder::CalculateCRC(data, number_of_nibbles, mSettings->legacyCRC);
+	AddNibble(12 + crc, samples_per_tick);
+	frame_ticks += 12 + crc;
+	/* Pause pulse, up to the length of the longest possible frame plus 12 ticks */
+	if(mSettings->pausePulseEnabled)
+	{
+		AddNibble(56 + 27 * (number_of_nibbles + 2) + 12 - frame_ticks, samples_per_tick);
+	}
+
+	mFrameCounter++;
 }
 
 void SENTSimulationDataGenerator::CreateSerialByte()
 {
 	U32 samples_per_tick = mSimulationSampleRateHz * ((float)mSettings->tick_time_half_us / 2.0) / 1000000;
 
-	if ( mSettings->pausePulseEnabled )
+	if ( mSettings->simulationScenario != SimulationFixedFrames )
+	{
+		CreateCounterFrame();
+	}
+	else if ( mSettings->pausePulseEnabled )
 	{
 	    /* First, a normal SENT frame */
 
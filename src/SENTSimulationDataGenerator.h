@@ -20,9 +20,17 @@ protected:
 
 protected:
 	void CreateSerialByte();
-	void AddNibble(U16 number_of_ticks, U16 samples_per_tick);
+	void CreateCounterFrame();
+	void AddNibble(U16 number_of_ticks, double samples_per_tick);
+	U32 random(U32 range);
 
 	SimulationChannelDescriptor mSerialSimulationData;
 
+	/* Ideal sample number of the next falling edge, without jitter */
+	double mNextEdge;
+	U32 mFrameCounter;
+	/* State of the pseudo random generator, seeded identically on every simulation */
+	U32 mRandomState;
+
 };
-#endif //SENT_SIMULATION_DATA_GENERATOR
\ No newline at end of file
+#endif //SENT_SIMULATION_DATA_GENERATOR
@@ -0,0 +1,156 @@
+#include "SENTValueOverview.h"
+
+SENTValueOverview::SENTValueOverview()
+:	mBucketShift( 0 ),
+	mFinestLevel( 0 )
+{
+}
+
+SENTValueOverview::~SENTValueOverview()
+{
+}
+
+/** Clears the overview and sets its time scale
+ *
+ *  @param [in] 	bucket_shift 	Level 0 buckets span 2^bucket_shift samples
+ */
+void SENTValueOverview::Initialize( U32 bucket_shift )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+
+	mBucketShift = bucket_shift;
+	mFinestLevel = 0;
+	mBuckets.clear();
+	mBuckets.reserve( OVERVIEW_BUCKETS );
+}
+
+/** Merges every pair of buckets of a level into a bucket of the next coarser level, in place
+ *
+ *  @param [in,out] 	buckets 	The non-empty buckets of a level, in order
+ */
+void SENTValueOverview::MergeBucketPairs( std::vector<SENTValueBucket>& buckets )
+{
+	U32 merged = 0;
+
+	for( U32 i = 0; i < buckets.size(); i++ )
+	{
+		SENTValueBucket bucket = buckets[i];
+		bucket.index >>= 1;
+
+		if( merged > 0 && buckets[merged - 1].index == bucket.index )
+		{
+			SENTValueBucket& target = buckets[merged - 1];
+			if( bucket.messages > 0 )
+			{
+				if( target.messages == 0 || bucket.min < target.min )
+				{
+					target.min = bucket.min;
+				}
+				if( target.messages == 0 || bucket.max > target.max )
+				{
+					target.max = bucket.max;
+				}
+			}
+			target.messages += bucket.messages;
+			target.errors += bucket.errors;
+			target.sum += bucket.sum;
+		}
+		else
+		{
+			buckets[merged++] = bucket;
+		}
+	}
+	buckets.resize( merged );
+}
+
+/** Adds a packet to the bucket it falls in
+ *
+ *  Packets are added in order, so the bucket to update is always the last one
+ *
+ *  @param [in] 	sample 		The sample number of the start of the packet
+ *  @param [in] 	value 		The fast channel value of the packet
+ *  @param [in] 	has_value 	Whether the value is valid, i.e. the packet passed the nibble number and CRC checks
+ *  @param [in] 	has_error 	Whether the packet contains an error
+ */
+void SENTValueOverview::AddPacket( U64 sample, U32 value, bool has_value, bool has_error )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+
+	U64 index = sample >> ( mBucketShift + mFinestLevel );
+	while( ( mBuckets.empty() || mBuckets.back().index != index ) && ( mBuckets.size() >= OVERVIEW_BUCKETS ) && ( mFinestLevel + 1 < OVERVIEW_LEVELS ) )
+	{
+		MergeBucketPairs( mBuckets );
+		mFinestLevel++;
+		index >>= 1;
+	}
+
+	if( mBuckets.empty() || mBuckets.back().index != index )
+	{
+		SENTValueBucket bucket = SENTValueBucket();
+		bucket.index = index;
+		mBuckets.push_back( bucket );
+	}
+
+	SENTValueBucket& bucket = mBuckets.back();
+	if( has_value )
+	{
+		if( bucket.messages == 0 || value < bucket.min )
+		{
+			bucket.min = value;
+		}
+		if( bucket.messages == 0 || value > bucket.max )
+		{
+			bucket.max = value;
+		}
+		bucket.messages++;
+		bucket.sum += value;
+	}
+	if( has_error )
+	{
+		bucket.errors++;
+	}
+}
+
+/** Returns the finest level that is still available, the finer ones were merged into it */
+U32 SENTValueOverview::GetFinestLevel()
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+
+	return mFinestLevel;
+}
+
+/** Returns the number of samples spanned by a bucket of the given level */
+U64 SENTValueOverview::GetBucketSamples( U32 level )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+
+	return 1ull << ( mBucketShift + level );
+}
+
+/** Copies the buckets of the given level
+ *
+ *  Only the (bounded) finest kept level is copied while holding the mutex, the coarser levels are merged from the copy.
+ *
+ *  @param [in] 	level 		The level, 0 is the finest one
+ *  @param [out] 	buckets 	The non-empty buckets of the level, in order. Empty if the level is finer than the finest kept level.
+ */
+void SENTValueOverview::GetLevel( U32 level, std::vector<SENTValueBucket>& buckets )
+{
+	U32 finest_level;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+
+		finest_level = mFinestLevel;
+		if( level < finest_level || level >= OVERVIEW_LEVELS )
+		{
+			buckets.clear();
+			return;
+		}
+		buckets = mBuckets;
+	}
+
+	for( U32 i = finest_level; i < level; i++ )
+	{
+		MergeBucketPairs( buckets );
+	}
+}
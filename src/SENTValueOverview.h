@@ -0,0 +1,55 @@
+#ifndef SENT_VALUE_OVERVIEW
+#define SENT_VALUE_OVERVIEW
+
+#include <LogicPublicTypes.h>
+#include <mutex>
+#include <vector>
+
+/* Number of levels in the overview. Level n buckets span 2^n level 0 buckets */
+#define OVERVIEW_LEVELS 	(32)
+/* Largest number of buckets kept. When the capture outgrows them, the finest kept level becomes one level coarser */
+#define OVERVIEW_BUCKETS 	(4096)
+
+/* Summary of the packets that started within a bucket of time */
+struct SENTValueBucket
+{
+	U64 index;			/* The bucket starts at sample index << (bucket shift of its level) */
+	U32 messages;		/* Number of packets with a valid fast channel value */
+	U32 errors;			/* Number of packets with an error */
+	U32 min;
+	U32 max;
+	double sum;			/* Sum of the fast channel values, for the mean */
+};
+
+/** Multi-resolution summary of the decoded fast channel values
+ *
+ *  The overview is a pyramid of buckets at power of two time scales. Only the finest kept level is stored,
+ *  in at most OVERVIEW_BUCKETS buckets: when a packet needs one more bucket, pairs of buckets are merged and
+ *  the finest kept level becomes one level coarser. The coarser levels are merged from it on request.
+ *  The memory use is thus constant, whatever the capture length, and the overview is always up to date while decoding.
+ *
+ *  Packets are added from the analyzer thread and the levels are read from the GUI thread, hence the mutex.
+ */
+class SENTValueOverview
+{
+public:
+	SENTValueOverview();
+	~SENTValueOverview();
+
+	void Initialize( U32 bucket_shift );
+	void AddPacket( U64 sample, U32 value, bool has_value, bool has_error );
+
+	U32 GetFinestLevel();
+	U64 GetBucketSamples( U32 level );
+	void GetLevel( U32 level, std::vector<SENTValueBucket>& buckets );
+
+protected:
+	static void MergeBucketPairs( std::vector<SENTValueBucket>& buckets );
+
+	U32 mBucketShift;
+	U32 mFinestLevel;
+	std::vector<SENTValueBucket> mBuckets;
+	std::mutex mMutex;
+};
+
+#endif //SENT_VALUE_OVERVIEW
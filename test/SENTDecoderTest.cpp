@@ -0,0 +1,896 @@
+#include "SENTDecoder.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* Exit code that makes CTest report the test as skipped, see SKIP_RETURN_CODE in CMakeLists.txt */
+#define TEST_SKIPPED 			(77)
+
+/* Nominal tick time of the generated traces in samples, a 3 us tick sampled at 24 MHz */
+#define TRACE_SAMPLES_PER_TICK 	(72.0)
+/* Number of frames of every corpus trace, one period of the drift */
+#define CORPUS_FRAMES 			(2000)
+/* Number of frames of the traces used for the performance counters */
+#define PERFORMANCE_FRAMES 		(100000)
+
+/* Same noise model as the "Noisy" simulation: number of frames of one period of the tick time drift,
+   largest tick time deviation, largest edge jitter in ticks, and roughly one glitch and one missed edge per this many frames */
+#define DRIFT_PERIOD_FRAMES 	(2000)
+#define DRIFT_MAX 				(0.1)
+#define JITTER_MAX_TICKS 		(0.2)
+#define NOISE_FRAMES 			(100)
+
+/* Resynchronisation checks: number of frames per trace, one in this many of them gets a single fault */
+#define FAULT_FRAMES 			(4000)
+#define FAULT_INTERVAL 			(4)
+/* Out of range pulses inserted between two frames, and their length in ticks */
+#define STRETCH_PULSES 			(40)
+#define STRETCH_TICKS 			(5)
+/* Largest share of false recoveries among the resynchronised messages of the noisy corpus */
+#define FALSE_RECOVERY_MAX 		(0.05)
+
+enum TraceScenario { TraceClean, TraceDrift, TraceNoisy };
+enum TraceFault { FaultNone, FaultGlitch, FaultMissedEdge };
+
+struct TraceSettings
+{
+	TraceScenario scenario;
+	U32 number_of_data_nibbles;
+	bool pause_pulse_enabled;
+	U16 pause_ticks;						/* Fixed length of the pause pulse, 0 for a constant message period */
+	bool legacy_crc;
+	bool resync_enabled;
+};
+
+/* A frame as it was sent */
+struct TraceFrame
+{
+	double start;							/* Ideal falling edge at the start of the sync pulse, without jitter */
+	U32 value;
+	U8 status;
+};
+
+struct Trace
+{
+	std::vector<U64> edges;					/* Falling edges as seen by the decoder */
+	std::vector<TraceFrame> frames;
+};
+
+/* Summary of the decoding of a trace, compared against the golden file */
+struct TraceResult
+{
+	U32 messages;
+	U32 valid;
+	U32 crc_errors;
+	U32 nibble_errors;
+	U32 resynchronised;
+	U32 wrong_values;						/* Valid messages whose value or status differs from the frame sent at that time */
+	U32 false_recoveries;					/* Wrong values of resynchronised messages */
+	U64 hash;								/* FNV-1a hash of all fields of all decoded messages */
+};
+
+/** Seeded generator of the falling edges of a SENT line
+ *
+ *  Frames carry random status and data nibbles with a valid CRC. With a pause pulse, the message period is constant.
+ *  The drift and noise follow the simulation scenarios of the analyzer (see SENTSimulationDataGenerator), but only
+ *  the falling edges are generated: a glitch adds an edge, a missed edge removes one.
+ *  The same settings and seed always give the same trace, on every platform.
+ */
+class TraceGenerator
+{
+public:
+	TraceGenerator( const TraceSettings& settings, U32 seed );
+	~TraceGenerator();
+
+	void Generate( U32 number_of_frames, Trace& trace );
+
+protected:
+	U32 random( U32 range );
+	void addPulse( U16 number_of_ticks, double samples_per_tick, Trace& trace );
+
+	TraceSettings mSettings;
+	U32 mRandomState;
+	/* Ideal sample number of the next falling edge, without jitter */
+	double mNextEdge;
+};
+
+TraceGenerator::TraceGenerator( const TraceSettings& settings, U32 seed )
+:	mSettings( settings ),
+	mRandomState( seed ),
+	mNextEdge( 1000 )
+{
+}
+
+TraceGenerator::~TraceGenerator()
+{
+}
+
+/** Pseudo random number in range [0:range[, the linear congruential generator of the simulation */
+U32 TraceGenerator::random( U32 range )
+{
+	mRandomState = mRandomState * 1103515245 + 12345;
+	return ( mRandomState >> 16 ) % range;
+}
+
+/** Adds the falling edge(s) of a single pulse
+ *
+ *  @param [in] 		number_of_ticks 	The total length of the pulse in ticks
+ *  @param [in] 		samples_per_tick 	The tick time in samples
+ *  @param [in,out] 	trace 				The trace to add the edges to
+ */
+void TraceGenerator::addPulse( U16 number_of_ticks, double samples_per_tick, Trace& trace )
+{
+	bool noisy = ( mSettings.scenario == TraceNoisy );
+	double edge = mNextEdge;
+	mNextEdge += number_of_ticks * samples_per_tick;
+
+	/* Missed edge, this pulse merges with the previous one */
+	if( noisy && ( random( NOISE_FRAMES * 10 ) == 0 ) )
+	{
+		return;
+	}
+	if( noisy )
+	{
+		edge += ( random( 2001 ) / 1000.0 - 1.0 ) * JITTER_MAX_TICKS * samples_per_tick;
+	}
+	U64 falling_edge = round( edge );
+	if( trace.edges.empty() || falling_edge > trace.edges.back() )
+	{
+		trace.edges.push_back( falling_edge );
+	}
+
+	/* Glitch, a short low pulse after the 5 ticks low time splits this pulse in two */
+	if( noisy && ( number_of_ticks > 10 ) && ( random( NOISE_FRAMES * 10 ) == 0 ) )
+	{
+		trace.edges.push_back( round( edge + ( 5 + random( number_of_ticks - 7 ) + 1 ) * samples_per_tick ) );
+	}
+}
+
+/** Generates the given number of frames, and the edge that ends the last one
+ *
+ *  @param [in] 	number_of_frames 	The number of frames to generate
+ *  @param [out] 	trace 				The generated edges and frames
+ */
+void TraceGenerator::Generate( U32 number_of_frames, Trace& trace )
+{
+	U32 number_of_nibbles = mSettings.number_of_data_nibbles;
+
+	trace.edges.clear();
+	trace.frames.clear();
+	trace.edges.reserve( number_of_frames * ( number_of_nibbles + 4 ) * 11 / 10 + 1 );
+	trace.frames.reserve( number_of_frames );
+
+	for( U32 frame = 0; frame < number_of_frames; frame++ )
+	{
+		double samples_per_tick = TRACE_SAMPLES_PER_TICK;
+		if( mSettings.scenario == TraceDrift )
+		{
+			double phase = (double)( frame % DRIFT_PERIOD_FRAMES ) / DRIFT_PERIOD_FRAMES;
+			samples_per_tick *= 1.0 + DRIFT_MAX * ( 4 * fabs( phase - 0.5 ) - 1 );
+		}
+
+		TraceFrame sent;
+		U8 data[SENT_MAX_DATA_NIBBLES];
+		sent.start = mNextEdge;
+		sent.status = random( 16 );
+		U32 frame_ticks = 56 + 12 + sent.status;
+		sent.value = 0;
+		for( U32 i = 0; i < number_of_nibbles; i++ )
+		{
+			data[i] = random( 16 );
+			sent.value = ( sent.value << 4 ) | data[i];
+			frame_ticks += 12 + data[i];
+		}
+		U8 crc = SENTDecoder::CalculateCRC( data, number_of_nibbles, mSettings.legacy_crc );
+		frame_ticks += 12 + crc;
+		trace.frames.push_back( sent );
+
+		addPulse( 56, samples_per_tick, trace );
+		addPulse( 12 + sent.status, samples_per_tick, trace );
+		for( U32 i = 0; i < number_of_nibbles; i++ )
+		{
+			addPulse( 12 + data[i], samples_per_tick, trace );
+		}
+		addPulse( 12 + crc, samples_per_tick, trace );
+		/* Pause pulse, up to the length of the longest possible frame plus 12 ticks */
+		if( mSettings.pause_pulse_enabled && mSettings.pause_ticks == 0 )
+		{
+			addPulse( 56 + 27 * ( number_of_nibbles + 2 ) + 12 - frame_ticks, samples_per_tick, trace );
+		}
+		else if( mSettings.pause_pulse_enabled )
+		{
+			addPulse( mSettings.pause_ticks, samples_per_tick, trace );
+		}
+	}
+	trace.edges.push_back( round( mNextEdge ) );
+}
+
+/** Name of a trace in the golden file */
+static std::string traceName( const TraceSettings& settings )
+{
+	static const char* scenarios[] = { "clean", "drift", "noisy" };
+	std::ostringstream name;
+	name << scenarios[settings.scenario] << "_n" << settings.number_of_data_nibbles
+		 << ( settings.pause_pulse_enabled ? "_pause" : "_nopause" )
+		 << ( settings.legacy_crc ? "_legacycrc" : "_crc" )
+		 << ( settings.resync_enabled ? "_resync" : "_noresync" );
+	return name.str();
+}
+
+/** Decodes all edges of a trace
+ *
+ *  @param [in] 	settings 	The settings of the trace, the decoder is configured the same way
+ *  @param [in] 	edges 		The falling edges
+ *  @param [out] 	messages 	The decoded messages
+ */
+static void decodeTrace( const TraceSettings& settings, const std::vector<U64>& edges, std::vector<SENTMessage>& messages )
+{
+	SENTDecoder decoder;
+	SENTMessage message;
+
+	decoder.Initialize( TRACE_SAMPLES_PER_TICK, settings.number_of_data_nibbles, settings.pause_pulse_enabled,
+						settings.legacy_crc, settings.resync_enabled );
+	messages.clear();
+	messages.reserve( edges.size() / ( settings.number_of_data_nibbles + 3 ) + 1 );
+	for( std::vector<U64>::const_iterator it = edges.begin(); it != edges.end(); it++ )
+	{
+		if( decoder.AddFallingEdge( *it, message ) )
+		{
+			messages.push_back( message );
+		}
+	}
+}
+
+static void hashBytes( U64& hash, const void* data, U32 size )
+{
+	const U8* bytes = static_cast<const U8*>( data );
+	for( U32 i = 0; i < size; i++ )
+	{
+		hash = ( hash ^ bytes[i] ) * 1099511628211ULL;
+	}
+}
+
+/** Summarises the decoded messages of a trace, checking every valid message against the frame sent at that time */
+static TraceResult summariseTrace( const Trace& trace, const std::vector<SENTMessage>& messages )
+{
+	TraceResult result;
+	memset( &result, 0, sizeof( result ) );
+	result.hash = 14695981039346656037ULL;
+	result.messages = messages.size();
+
+	U32 frame = 0;
+	for( std::vector<SENTMessage>::const_iterator it = messages.begin(); it != messages.end(); it++ )
+	{
+		/* Field by field, the padding of the structure is not part of the hash */
+		hashBytes( result.hash, &it->start_sample, sizeof( it->start_sample ) );
+		hashBytes( result.hash, &it->end_sample, sizeof( it->end_sample ) );
+		hashBytes( result.hash, &it->value, sizeof( it->value ) );
+		hashBytes( result.hash, &it->status, sizeof( it->status ) );
+		hashBytes( result.hash, it->data, sizeof( it->data ) );
+		hashBytes( result.hash, &it->crc, sizeof( it->crc ) );
+		hashBytes( result.hash, &it->number_of_pulses, sizeof( it->number_of_pulses ) );
+		hashBytes( result.hash, &it->error, sizeof( it->error ) );
+		hashBytes( result.hash, &it->resynchronised, sizeof( it->resynchronised ) );
+
+		result.crc_errors += ( it->error == MessageCrcError );
+		result.nibble_errors += ( it->error == MessageNibbleNumberError );
+		result.resynchronised += ( it->resynchronised != 0 );
+		if( it->error != MessageValid )
+		{
+			continue;
+		}
+		result.valid++;
+
+		/* The sync pulse of the sent frame starts within a tick of the message, whatever the drift and jitter */
+		while( frame < trace.frames.size() && trace.frames[frame].start + TRACE_SAMPLES_PER_TICK < it->start_sample )
+		{
+			frame++;
+		}
+		if( frame == trace.frames.size() || fabs( trace.frames[frame].start - it->start_sample ) > TRACE_SAMPLES_PER_TICK ||
+			trace.frames[frame].value != it->value || trace.frames[frame].status != it->status )
+		{
+			result.wrong_values++;
+			result.false_recoveries += ( it->resynchronised != 0 );
+		}
+	}
+	return result;
+}
+
+static std::string formatResult( const std::string& name, const TraceResult& result )
+{
+	char line[256];
+	snprintf( line, sizeof( line ), "%s messages %u valid %u crc %u nibble %u resynchronised %u wrong %u hash %016llx",
+			  name.c_str(), result.messages, result.valid, result.crc_errors, result.nibble_errors, result.resynchronised,
+			  result.wrong_values, (unsigned long long)result.hash );
+	return line;
+}
+
+/** All traces of the corpus: every scenario, number of data nibbles, with and without pause pulse and resynchronisation.
+ *  Odd numbers of data nibbles use the legacy CRC, so that both CRC variants are covered.
+ */
+static std::vector<TraceSettings> corpusSettings()
+{
+	std::vector<TraceSettings> corpus;
+	for( U32 scenario = TraceClean; scenario <= TraceNoisy; scenario++ )
+	{
+		for( U32 nibbles = 0; nibbles <= SENT_MAX_DATA_NIBBLES; nibbles++ )
+		{
+			for( U32 pause = 0; pause < 2; pause++ )
+			{
+				for( U32 resync = 0; resync < 2; resync++ )
+				{
+					TraceSettings settings;
+					settings.scenario = (TraceScenario)scenario;
+					settings.number_of_data_nibbles = nibbles;
+					settings.pause_pulse_enabled = ( pause != 0 );
+					settings.pause_ticks = 0;
+					settings.legacy_crc = ( nibbles % 2 ) != 0;
+					settings.resync_enabled = ( resync != 0 );
+					corpus.push_back( settings );
+				}
+			}
+		}
+	}
+	return corpus;
+}
+
+/** Decodes the corpus and compares the summary of every trace with the golden file
+ *
+ *  @param [in] 	golden_file 	The golden file
+ *  @param [in] 	update 			Rewrite the golden file instead of comparing against it
+ *  @returns 	int 	The exit code of the test
+ */
+static int runCorpus( const char* golden_file, bool update )
+{
+	std::vector<TraceSettings> corpus = corpusSettings();
+	std::vector<std::string> names;
+	std::vector<std::string> lines;
+	Trace trace;
+	std::vector<SENTMessage> messages;
+
+	for( U32 i = 0; i < corpus.size(); i++ )
+	{
+		/* Every trace has its own seed, so that adding traces does not change the existing ones */
+		TraceGenerator generator( corpus[i], i + 1 );
+		generator.Generate( CORPUS_FRAMES, trace );
+		decodeTrace( corpus[i], trace.edges, messages );
+		names.push_back( traceName( corpus[i] ) );
+		lines.push_back( formatResult( names.back(), summariseTrace( trace, messages ) ) );
+	}
+
+	if( update )
+	{
+		std::ofstream file_stream( golden_file, std::ios::out );
+		file_stream << "# Decoded messages of the generated traces, regenerate with: sent_decoder_test corpus <this file> --update" << std::endl;
+		file_stream << "# <trace> messages <n> valid <n> crc <n> nibble <n> resynchronised <n> wrong <n> hash <FNV-1a of all message fields>" << std::endl;
+		for( U32 i = 0; i < lines.size(); i++ )
+		{
+			file_stream << lines[i] << std::endl;
+		}
+		if( !file_stream )
+		{
+			fprintf( stderr, "could not write %s\n", golden_file );
+			return 1;
+		}
+		printf( "wrote %u traces to %s\n", (U32)lines.size(), golden_file );
+		return 0;
+	}
+
+	std::ifstream golden_stream( golden_file );
+	if( !golden_stream )
+	{
+		fprintf( stderr, "could not read %s\n", golden_file );
+		return 1;
+	}
+	std::map<std::string, std::string> golden;
+	std::string line;
+	while( std::getline( golden_stream, line ) )
+	{
+		if( !line.empty() && line[0] != '#' )
+		{
+			golden[line.substr( 0, line.find( ' ' ) )] = line;
+		}
+	}
+
+	U32 failures = 0;
+	for( U32 i = 0; i < lines.size(); i++ )
+	{
+		std::map<std::string, std::string>::iterator expected = golden.find( names[i] );
+		if( expected == golden.end() || expected->second != lines[i] )
+		{
+			printf( "FAIL %s\n  expected: %s\n  actual:   %s\n", names[i].c_str(),
+					expected == golden.end() ? "(missing)" : expected->second.c_str(), lines[i].c_str() );
+			failures++;
+		}
+	}
+	printf( "%u of %u traces match %s\n", (U32)lines.size() - failures, (U32)lines.size(), golden_file );
+	return failures == 0 ? 0 : 1;
+}
+
+/** Adds a single fault to one in FAULT_INTERVAL frames of a clean trace
+ *
+ *  The fault moves through the data carrying pulses (status, data and CRC nibbles) from one faulty frame to the next.
+ *  A glitch splits the pulse at a tick that moves through the high time of the pulse. A missed edge merges the pulse
+ *  with the previous data carrying pulse.
+ *
+ *  @param [in] 		settings 	The settings the trace was generated with
+ *  @param [in] 		fault 		The fault to add
+ *  @param [in,out] 	trace 		The trace, without noise
+ */
+static void addFaults( const TraceSettings& settings, TraceFault fault, Trace& trace )
+{
+	U32 pulses_per_frame = settings.number_of_data_nibbles + ( settings.pause_pulse_enabled ? 4 : 3 );
+	U32 data_pulses = settings.number_of_data_nibbles + 2;
+	std::vector<U64> edges;
+	edges.reserve( trace.edges.size() + trace.frames.size() );
+
+	for( U32 i = 0; i < trace.edges.size(); i++ )
+	{
+		U32 frame = i / pulses_per_frame;
+		U32 pulse = i % pulses_per_frame;
+		U32 fault_number = frame / FAULT_INTERVAL;
+		bool faulty = ( fault != FaultNone ) && ( frame % FAULT_INTERVAL == 1 ) && ( i + 1 < trace.edges.size() );
+
+		if( faulty && fault == FaultMissedEdge && pulse == 2 + fault_number % ( data_pulses - 1 ) )
+		{
+			continue;
+		}
+		edges.push_back( trace.edges[i] );
+		if( faulty && fault == FaultGlitch && pulse == 1 + fault_number % data_pulses )
+		{
+			U32 number_of_ticks = round( ( trace.edges[i + 1] - trace.edges[i] ) / TRACE_SAMPLES_PER_TICK );
+			U32 glitch_ticks = 6 + ( fault_number / data_pulses ) % ( number_of_ticks - 6 );
+			edges.push_back( trace.edges[i] + round( glitch_ticks * TRACE_SAMPLES_PER_TICK ) );
+		}
+	}
+	trace.edges.swap( edges );
+}
+
+/* Outcome of the decoding of the frames of a trace with faults */
+struct FaultResult
+{
+	U32 recovered;							/* Faulty frames decoded to the value sent, flagged as resynchronised */
+	U32 rejected;							/* Faulty frames reported as an error */
+	U32 wrong;								/* Valid messages with a value that was not sent, or intact frames resynchronised */
+	U32 collateral;							/* Intact frames that were not decoded as sent */
+};
+
+/** Decodes a trace with faults, and checks every frame against what was sent
+ *
+ *  @param [in] 	settings 	The settings of the trace
+ *  @param [in] 	fault 		The fault added to the trace
+ *  @returns 	FaultResult 	The outcome per frame
+ */
+static FaultResult checkFaults( const TraceSettings& settings, TraceFault fault )
+{
+	FaultResult result;
+	memset( &result, 0, sizeof( result ) );
+
+	Trace trace;
+	TraceGenerator generator( settings, 1 );
+	generator.Generate( FAULT_FRAMES, trace );
+	addFaults( settings, fault, trace );
+
+	std::vector<SENTMessage> messages;
+	decodeTrace( settings, trace.edges, messages );
+
+	/* Per frame: 0 not decoded, 1 decoded as sent, 2 decoded as sent after resynchronisation */
+	std::vector<U8> decoded( trace.frames.size(), 0 );
+	U32 frame = 0;
+	for( std::vector<SENTMessage>::const_iterator it = messages.begin(); it != messages.end(); it++ )
+	{
+		if( it->error != MessageValid )
+		{
+			continue;
+		}
+		while( frame < trace.frames.size() && trace.frames[frame].start + TRACE_SAMPLES_PER_TICK < it->start_sample )
+		{
+			frame++;
+		}
+		if( frame == trace.frames.size() || fabs( trace.frames[frame].start - it->start_sample ) > TRACE_SAMPLES_PER_TICK ||
+			trace.frames[frame].value != it->value || trace.frames[frame].status != it->status )
+		{
+			result.wrong++;
+			continue;
+		}
+		decoded[frame] = it->resynchronised ? 2 : 1;
+	}
+
+	/* The last frame is only completed by a sync pulse that never comes */
+	for( U32 i = 0; i + 1 < trace.frames.size(); i++ )
+	{
+		bool faulty = ( fault != FaultNone ) && ( i % FAULT_INTERVAL == 1 );
+		if( faulty && decoded[i] == 2 )
+		{
+			result.recovered++;
+		}
+		else if( faulty && decoded[i] == 1 )
+		{
+			/* A fault can not go unnoticed */
+			result.wrong++;
+		}
+		else if( faulty )
+		{
+			result.rejected++;
+		}
+		else if( decoded[i] == 2 )
+		{
+			result.wrong++;
+		}
+		else if( decoded[i] == 0 )
+		{
+			result.collateral++;
+		}
+	}
+	return result;
+}
+
+/** Decodes a trace with a stretch of out of range pulses between two frames, without resynchronisation
+ *
+ *  @param [in] 	number_of_data_nibbles 	The number of data nibbles of the frames
+ *  @param [out] 	errors 					The number of messages with an error
+ *  @param [out] 	number_of_pulses 		The number of pulses of the first message with an error
+ *  @returns 	U32 	The number of valid messages
+ */
+static U32 checkStretch( U32 number_of_data_nibbles, U32& errors, U32& number_of_pulses )
+{
+	TraceSettings settings;
+	settings.scenario = TraceClean;
+	settings.number_of_data_nibbles = number_of_data_nibbles;
+	settings.pause_pulse_enabled = false;
+	settings.pause_ticks = 0;
+	settings.legacy_crc = false;
+	settings.resync_enabled = false;
+
+	Trace trace;
+	TraceGenerator generator( settings, 1 );
+	generator.Generate( 10, trace );
+
+	/* The stretch is inserted right before the sync pulse of the 6th frame */
+	U32 stretch_edge = 5 * ( number_of_data_nibbles + 3 );
+	U64 stretch_samples = round( STRETCH_TICKS * TRACE_SAMPLES_PER_TICK );
+	std::vector<U64> edges( trace.edges.begin(), trace.edges.begin() + stretch_edge + 1 );
+	for( U32 i = stretch_edge; i < trace.edges.size(); i++ )
+	{
+		if( i == stretch_edge )
+		{
+			for( U32 j = 1; j <= STRETCH_PULSES; j++ )
+			{
+				edges.push_back( trace.edges[i] + j * stretch_samples );
+			}
+		}
+		else
+		{
+			edges.push_back( trace.edges[i] + STRETCH_PULSES * stretch_samples );
+		}
+	}
+
+	std::vector<SENTMessage> messages;
+	decodeTrace( settings, edges, messages );
+	U32 valid = 0;
+	errors = 0;
+	number_of_pulses = 0;
+	for( std::vector<SENTMessage>::const_iterator it = messages.begin(); it != messages.end(); it++ )
+	{
+		if( it->error == MessageValid )
+		{
+			valid++;
+		}
+		else if( errors++ == 0 )
+		{
+			number_of_pulses = it->number_of_pulses;
+		}
+	}
+	return valid;
+}
+
+/** Checks the resynchronisation on single faults, and its false recoveries on the noisy corpus
+ *
+ *  - Glitch and missed edge: a faulty frame is either recovered to the value sent, or rejected. It is never decoded to another value.
+ *    With resynchronisation, the intact frames around it are always decoded. Without resynchronisation, faulty frames are always
+ *    rejected, and a sync sized pause pulse after a fault may cost the next frame.
+ *  - Sync sized pause pulse (56 ticks): with resynchronisation, the choice between sync and pause pulse does not depend on the nibble
+ *    counter, with or without faults.
+ *  - Out of range pulses: without resynchronisation, a stretch of them up to the next sync pulse is a single error,
+ *    which still counts all of its pulses. The frames around it are decoded.
+ *  - Noisy corpus: jitter and several faults per frame can make a wrong alignment pass the CRC4. The share of such false recoveries
+ *    among the resynchronised messages is bounded.
+ *
+ *  @returns 	int 	The exit code of the test
+ */
+static int runResync()
+{
+	static const char* faults[] = { "none", "glitch", "missed-edge" };
+	const U32 nibbles[] = { 1, 3, 6 };
+	const U16 pauses[] = { 0, 0, 56 };
+	U32 failures = 0;
+
+	for( U32 n = 0; n < sizeof( nibbles ) / sizeof( nibbles[0] ); n++ )
+	{
+		for( U32 p = 0; p < sizeof( pauses ) / sizeof( pauses[0] ); p++ )
+		{
+			for( U32 fault = FaultNone; fault <= FaultMissedEdge; fault++ )
+			{
+				for( U32 resync = 0; resync < 2; resync++ )
+				{
+					TraceSettings settings;
+					settings.scenario = TraceClean;
+					settings.number_of_data_nibbles = nibbles[n];
+					/* The first pause entry is a frame without pause pulse */
+					settings.pause_pulse_enabled = ( p > 0 );
+					settings.pause_ticks = pauses[p];
+					settings.legacy_crc = false;
+					settings.resync_enabled = ( resync != 0 );
+
+					FaultResult result = checkFaults( settings, (TraceFault)fault );
+					bool failed = ( result.wrong > 0 ) || ( !settings.resync_enabled && result.recovered > 0 ) ||
+								  ( settings.resync_enabled && fault != FaultNone && result.recovered == 0 ) ||
+								  ( settings.resync_enabled && result.collateral > 0 );
+					printf( "%s n%u %s %s %s: recovered %u rejected %u wrong %u collateral %u\n", failed ? "FAIL" : "ok",
+							nibbles[n], settings.pause_pulse_enabled ? ( pauses[p] == 56 ? "sync-sized-pause" : "pause" ) : "nopause",
+							faults[fault], settings.resync_enabled ? "resync" : "noresync",
+							result.recovered, result.rejected, result.wrong, result.collateral );
+					failures += failed;
+				}
+			}
+		}
+	}
+
+	for( U32 n = 0; n < sizeof( nibbles ) / sizeof( nibbles[0] ); n++ )
+	{
+		U32 errors;
+		U32 number_of_pulses;
+		/* The frame before the stretch is part of the error, the last frame is never completed */
+		U32 valid = checkStretch( nibbles[n], errors, number_of_pulses );
+		U32 expected_pulses = nibbles[n] + 2 + STRETCH_PULSES;
+		bool failed = ( valid != 8 ) || ( errors != 1 ) || ( number_of_pulses != expected_pulses );
+		printf( "%s n%u %u out of range pulses noresync: valid %u errors %u pulses %u, expected 8, 1 and %u\n", failed ? "FAIL" : "ok",
+				nibbles[n], STRETCH_PULSES, valid, errors, number_of_pulses, expected_pulses );
+		failures += failed;
+	}
+
+	std::vector<TraceSettings> corpus = corpusSettings();
+	U32 resynchronised = 0;
+	U32 false_recoveries = 0;
+	Trace trace;
+	std::vector<SENTMessage> messages;
+	for( U32 i = 0; i < corpus.size(); i++ )
+	{
+		if( corpus[i].scenario != TraceNoisy || !corpus[i].resync_enabled )
+		{
+			continue;
+		}
+		/* Same seeds as the corpus test */
+		TraceGenerator generator( corpus[i], i + 1 );
+		generator.Generate( CORPUS_FRAMES, trace );
+		decodeTrace( corpus[i], trace.edges, messages );
+		TraceResult result = summariseTrace( trace, messages );
+		resynchronised += result.resynchronised;
+		false_recoveries += result.false_recoveries;
+	}
+	bool failed = ( resynchronised == 0 ) || ( false_recoveries > FALSE_RECOVERY_MAX * resynchronised );
+	printf( "%s noisy corpus: %u false recoveries of %u resynchronised messages, at most %.0f%% allowed\n", failed ? "FAIL" : "ok",
+			false_recoveries, resynchronised, FALSE_RECOVERY_MAX * 100 );
+	failures += failed;
+
+	return failures == 0 ? 0 : 1;
+}
+
+/** A single perf_event_open counter of the calling thread, unavailable on other platforms
+ *  or when the kernel does not allow it (e.g. perf_event_paranoid, containers, virtual machines without PMU)
+ */
+class PerformanceCounter
+{
+public:
+	PerformanceCounter( U32 type, U64 config );
+	~PerformanceCounter();
+
+	bool IsAvailable() const;
+	void Start();
+	U64 Stop();
+
+protected:
+	int mFd;
+};
+
+PerformanceCounter::PerformanceCounter( U32 type, U64 config )
+:	mFd( -1 )
+{
+#ifdef __linux__
+	struct perf_event_attr attr;
+	memset( &attr, 0, sizeof( attr ) );
+	attr.size = sizeof( attr );
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	mFd = syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+#endif
+}
+
+PerformanceCounter::~PerformanceCounter()
+{
+#ifdef __linux__
+	if( mFd >= 0 )
+	{
+		close( mFd );
+	}
+#endif
+}
+
+bool PerformanceCounter::IsAvailable() const
+{
+	return mFd >= 0;
+}
+
+void PerformanceCounter::Start()
+{
+#ifdef __linux__
+	if( mFd >= 0 )
+	{
+		ioctl( mFd, PERF_EVENT_IOC_RESET, 0 );
+		ioctl( mFd, PERF_EVENT_IOC_ENABLE, 0 );
+	}
+#endif
+}
+
+U64 PerformanceCounter::Stop()
+{
+	U64 count = 0;
+#ifdef __linux__
+	if( mFd >= 0 )
+	{
+		ioctl( mFd, PERF_EVENT_IOC_DISABLE, 0 );
+		if( read( mFd, &count, sizeof( count ) ) != sizeof( count ) )
+		{
+			count = 0;
+		}
+	}
+#endif
+	return count;
+}
+
+/** Decodes a clean and a noisy trace and checks the counters per frame against the stored thresholds
+ *
+ *  The thresholds depend on whether the decoder is optimized. Counters that can not be opened are skipped,
+ *  and so is the test when none of them can.
+ *
+ *  @param [in] 	threshold_file 	Lines of "<build> <trace> <counter> <maximum per frame>"
+ *  @returns 	int 	The exit code of the test
+ */
+static int runPerformance( const char* threshold_file )
+{
+#ifdef __OPTIMIZE__
+	const std::string build = "optimized";
+#else
+	const std::string build = "unoptimized";
+#endif
+
+	std::ifstream threshold_stream( threshold_file );
+	if( !threshold_stream )
+	{
+		fprintf( stderr, "could not read %s\n", threshold_file );
+		return 1;
+	}
+	std::map<std::string, double> thresholds;
+	std::string line;
+	while( std::getline( threshold_stream, line ) )
+	{
+		std::istringstream fields( line );
+		std::string threshold_build, trace_name, counter_name;
+		double maximum;
+		if( !line.empty() && line[0] != '#' && ( fields >> threshold_build >> trace_name >> counter_name >> maximum ) &&
+			threshold_build == build )
+		{
+			thresholds[trace_name + " " + counter_name] = maximum;
+		}
+	}
+
+	const char* counter_names[] = { "task-clock-ns", "instructions", "cache-misses" };
+#ifdef __linux__
+	const U32 counter_types[] = { PERF_TYPE_SOFTWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+	const U64 counter_configs[] = { PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+#else
+	const U32 counter_types[] = { 0, 0, 0 };
+	const U64 counter_configs[] = { 0, 0, 0 };
+#endif
+	const U32 number_of_counters = sizeof( counter_names ) / sizeof( counter_names[0] );
+
+	U32 available = 0;
+	U32 failures = 0;
+	Trace trace;
+	std::vector<SENTMessage> messages;
+	const TraceScenario scenarios[] = { TraceClean, TraceNoisy };
+	for( U32 s = 0; s < sizeof( scenarios ) / sizeof( scenarios[0] ); s++ )
+	{
+		TraceSettings settings;
+		settings.scenario = scenarios[s];
+		settings.number_of_data_nibbles = SENT_MAX_DATA_NIBBLES;
+		settings.pause_pulse_enabled = true;
+		settings.pause_ticks = 0;
+		settings.legacy_crc = false;
+		settings.resync_enabled = true;
+		std::string trace_name = ( settings.scenario == TraceClean ) ? "clean" : "noisy";
+
+		TraceGenerator generator( settings, 1 );
+		generator.Generate( PERFORMANCE_FRAMES, trace );
+		/* Warm up, so that the measurement does not include the first page faults of the message buffer */
+		decodeTrace( settings, trace.edges, messages );
+
+		/* One counter per run, rather than a group, as some PMUs can not count all events at once */
+		for( U32 i = 0; i < number_of_counters; i++ )
+		{
+			PerformanceCounter counter( counter_types[i], counter_configs[i] );
+			if( !counter.IsAvailable() )
+			{
+				printf( "%s %s: counter unavailable, skipped\n", trace_name.c_str(), counter_names[i] );
+				continue;
+			}
+			available++;
+
+			counter.Start();
+			decodeTrace( settings, trace.edges, messages );
+			double per_frame = (double)counter.Stop() / PERFORMANCE_FRAMES;
+
+			std::string key = trace_name + " " + counter_names[i];
+			std::map<std::string, double>::iterator threshold = thresholds.find( key );
+			bool failed = ( threshold != thresholds.end() ) && ( per_frame > threshold->second );
+			printf( "%s %s: %.2f per frame", trace_name.c_str(), counter_names[i], per_frame );
+			if( i == 0 && per_frame > 0 )
+			{
+				printf( " (%.0f frames/s)", 1e9 / per_frame );
+			}
+			if( threshold != thresholds.end() )
+			{
+				printf( ", %s threshold %.2f%s\n", build.c_str(), threshold->second, failed ? " EXCEEDED" : "" );
+			}
+			else
+			{
+				printf( ", no %s threshold\n", build.c_str() );
+			}
+			failures += failed;
+		}
+	}
+
+	if( available == 0 )
+	{
+		printf( "no performance counters available, skipped\n" );
+		return TEST_SKIPPED;
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+int main( int argc, char* argv[] )
+{
+	if( argc >= 3 && strcmp( argv[1], "corpus" ) == 0 )
+	{
+		return runCorpus( argv[2], argc >= 4 && strcmp( argv[3], "--update" ) == 0 );
+	}
+	if( argc >= 2 && strcmp( argv[1], "resync" ) == 0 )
+	{
+		return runResync();
+	}
+	if( argc >= 3 && strcmp( argv[1], "performance" ) == 0 )
+	{
+		return runPerformance( argv[2] );
+	}
+
+	fprintf( stderr, "usage: %s corpus <golden file> [--update]\n"
+					 "       %s resync\n"
+					 "       %s performance <threshold file>\n", argv[0], argv[0], argv[0] );
+	return 2;
+}